@@ -0,0 +1,307 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+
+#include "button_gesture.h"
+#include "app_timer.h"
+#include "sdk_config.h"
+#include "app_util.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+
+// The button state is shared between scan_handler() and timeout_handler()
+// without a critical region.
+STATIC_ASSERT(BUTTON_SCAN_IRQ_PRIORITY == APP_TIMER_CONFIG_IRQ_PRIORITY);
+
+// Remaining ticks above this are a deadline in the past, see deadline_remaining().
+#define TICKS_PAST      0x800000
+
+typedef enum
+{
+    STATE_IDLE,
+    STATE_PRESSED,      // Held, no gesture yet. Deadline: long press.
+    STATE_RELEASED,     // Clicked once. Deadline: click.
+    STATE_HELD,         // Long press reported. Deadline: next repeat.
+    STATE_DONE          // Gesture reported, waits for the release.
+} state_t;
+
+typedef struct
+{
+    uint32_t pin_mask;
+    state_t  state;
+    uint32_t deadline;  // RTC ticks.
+    uint32_t released;  // RTC ticks at the last release.
+    uint16_t repeats;
+} button_t;
+
+APP_TIMER_DEF(m_gesture_timer_id);
+
+static button_t                 m_buttons[BUTTON_GESTURE_MAX_COUNT];
+static uint8_t                  m_count;
+static button_gesture_handler_t m_handler;
+
+
+// The counter wraps after 24 bits, so a deadline up to half the range in the past is expired.
+static uint32_t deadline_remaining(uint32_t deadline, uint32_t now)
+{
+    uint32_t remaining = app_timer_cnt_diff_compute(deadline, now);
+
+    return (remaining >= TICKS_PAST) ? 0 : remaining;
+}
+
+
+static bool waits(button_t const * p_button)
+{
+    return (p_button->state == STATE_PRESSED) ||
+           (p_button->state == STATE_RELEASED) ||
+           (p_button->state == STATE_HELD);
+}
+
+
+static void event_send(button_gesture_type_t type, uint32_t pins, uint16_t repeats)
+{
+    button_gesture_evt_t const evt =
+    {
+        .type    = type,
+        .pins    = pins,
+        .repeats = repeats
+    };
+
+    m_handler(&evt);
+}
+
+
+// Starts the shared timer for the earliest deadline.
+static void timer_schedule(uint32_t now)
+{
+    uint32_t next = UINT32_MAX;
+
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        if (waits(&m_buttons[i]))
+        {
+            uint32_t remaining = deadline_remaining(m_buttons[i].deadline, now);
+
+            if (remaining < next)
+            {
+                next = remaining;
+            }
+        }
+    }
+
+    (void)app_timer_stop(m_gesture_timer_id);
+    if (next != UINT32_MAX)
+    {
+        if (next < APP_TIMER_MIN_TIMEOUT_TICKS)
+        {
+            next = APP_TIMER_MIN_TIMEOUT_TICKS;
+        }
+        (void)app_timer_start(m_gesture_timer_id, next, NULL);
+    }
+}
+
+
+static void button_press(button_t * p_button, uint32_t state, uint32_t now)
+{
+    uint32_t chord = 0;
+
+    switch (p_button->state)
+    {
+        case STATE_RELEASED:
+            if (app_timer_cnt_diff_compute(now, p_button->released) < APP_TIMER_TICKS(BUTTON_GESTURE_BOUNCE_MS))
+            {
+                // Bounce, the first press goes on.
+                p_button->state    = STATE_PRESSED;
+                p_button->deadline = now + APP_TIMER_TICKS(BUTTON_GESTURE_LONG_MS);
+                return;
+            }
+            p_button->state = STATE_DONE;
+            event_send(BUTTON_GESTURE_DOUBLE_CLICK, p_button->pin_mask, 0);
+            return;
+
+        case STATE_IDLE:
+            break;
+
+        default:
+            return;
+    }
+
+    // Any other button still held without a gesture makes this a chord.
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        if ((m_buttons[i].state == STATE_PRESSED) && (state & m_buttons[i].pin_mask))
+        {
+            chord |= m_buttons[i].pin_mask;
+        }
+    }
+
+    if (chord != 0)
+    {
+        chord |= p_button->pin_mask;
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            if (chord & m_buttons[i].pin_mask)
+            {
+                m_buttons[i].state = STATE_DONE;
+            }
+        }
+        event_send(BUTTON_GESTURE_CHORD, chord, 0);
+        return;
+    }
+
+    p_button->state    = STATE_PRESSED;
+    p_button->deadline = now + APP_TIMER_TICKS(BUTTON_GESTURE_LONG_MS);
+}
+
+
+static void button_release(button_t * p_button, uint32_t now)
+{
+    if (p_button->state == STATE_PRESSED)
+    {
+        p_button->state    = STATE_RELEASED;
+        p_button->released = now;
+        p_button->deadline = now + APP_TIMER_TICKS(BUTTON_GESTURE_DOUBLE_MS);
+    }
+    else if (p_button->state != STATE_RELEASED)
+    {
+        p_button->state = STATE_IDLE;
+    }
+}
+
+
+static void button_timeout(button_t * p_button, uint32_t now)
+{
+    if (!waits(p_button) || (deadline_remaining(p_button->deadline, now) != 0))
+    {
+        return;
+    }
+
+    switch (p_button->state)
+    {
+        case STATE_PRESSED:
+            p_button->state     = STATE_HELD;
+            p_button->repeats   = 0;
+            p_button->deadline += APP_TIMER_TICKS(BUTTON_GESTURE_REPEAT_MS);
+            event_send(BUTTON_GESTURE_LONG_PRESS, p_button->pin_mask, 0);
+            break;
+
+        case STATE_HELD:
+            p_button->repeats++;
+            p_button->deadline += APP_TIMER_TICKS(BUTTON_GESTURE_REPEAT_MS);
+            event_send(BUTTON_GESTURE_REPEAT, p_button->pin_mask, p_button->repeats);
+            break;
+
+        case STATE_RELEASED:
+            p_button->state = STATE_IDLE;
+            event_send(BUTTON_GESTURE_CLICK, p_button->pin_mask, 0);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+// The scanner's TIMER interrupt (BUTTON_SCAN_IRQ_PRIORITY) and the
+// app_timer interrupt (APP_TIMER_CONFIG_IRQ_PRIORITY) run at the same
+// priority, checked above, so they never preempt each other.
+static void scan_handler(uint32_t pressed, uint32_t released, uint32_t state)
+{
+    uint32_t now = app_timer_cnt_get();
+
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        button_t * p_button = &m_buttons[i];
+
+        if (released & p_button->pin_mask)
+        {
+            button_release(p_button, now);
+        }
+        if (pressed & p_button->pin_mask)
+        {
+            button_press(p_button, state, now);
+        }
+    }
+
+    timer_schedule(now);
+}
+
+
+static void timeout_handler(void * p_context)
+{
+    uint32_t now = app_timer_cnt_get();
+
+    UNUSED_PARAMETER(p_context);
+
+    for (uint32_t i = 0; i < m_count; i++)
+    {
+        button_timeout(&m_buttons[i], now);
+    }
+
+    timer_schedule(now);
+}
+
+
+ret_code_t button_gesture_init(uint8_t const * p_pins, uint8_t count, bool active_low,
+                               button_gesture_handler_t handler)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_pins);
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    if (count > BUTTON_GESTURE_MAX_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_handler = handler;
+    m_count   = count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_buttons[i].pin_mask = BUTTON_SCAN_MASK(p_pins[i]);
+        m_buttons[i].state    = STATE_IDLE;
+    }
+
+    err_code = app_timer_create(&m_gesture_timer_id, APP_TIMER_MODE_SINGLE_SHOT, timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+    return button_scan_init(p_pins, count, active_low, scan_handler);
+}
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup button_gesture Button gestures
+ * @{
+ * @brief Click, double click, long press, repeat and chord detection on top of @ref button_scan.
+ *
+ * @details The edges reported by @ref button_scan are timestamped with the
+ *          application timer counter and run through a state machine per
+ *          button. Each gesture is delivered as one event:
+ *
+ *          - Click: press and release, and no second press within
+ *            @ref BUTTON_GESTURE_DOUBLE_MS.
+ *          - Double click: second press within @ref BUTTON_GESTURE_DOUBLE_MS
+ *            of the first release. Reported on the second press.
+ *          - Long press: held for @ref BUTTON_GESTURE_LONG_MS, followed by a
+ *            repeat every @ref BUTTON_GESTURE_REPEAT_MS until released.
+ *          - Chord: a button pressed while another one is held and has not
+ *            reported a gesture yet. All held buttons are part of the chord
+ *            and report nothing else until they are released.
+ *
+ *          A release followed by a press within @ref BUTTON_GESTURE_BOUNCE_MS
+ *          is taken as contact bounce and ignored.
+ *
+ *          All deadlines share one single shot application timer, which is
+ *          always started for the earliest of them and stopped when no button
+ *          waits for one. Without button activity there are no wakeups.
+ */
+
+#ifndef BUTTON_GESTURE_H__
+#define BUTTON_GESTURE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "button_scan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUTTON_GESTURE_MAX_COUNT    8       /**< Number of buttons. */
+#define BUTTON_GESTURE_DOUBLE_MS    300     /**< Longest gap between the clicks of a double click, and the delay of a click event. */
+#define BUTTON_GESTURE_LONG_MS      800     /**< Hold time of a long press. */
+#define BUTTON_GESTURE_REPEAT_MS    200     /**< Repeat interval while a long press is held. */
+#define BUTTON_GESTURE_BOUNCE_MS    10      /**< Shortest release that counts. */
+
+/**@brief Gesture types. */
+typedef enum
+{
+    BUTTON_GESTURE_CLICK,           /**< Single click. */
+    BUTTON_GESTURE_DOUBLE_CLICK,    /**< Double click. */
+    BUTTON_GESTURE_LONG_PRESS,      /**< Button held for the long press time. */
+    BUTTON_GESTURE_REPEAT,          /**< Long press still held. */
+    BUTTON_GESTURE_CHORD            /**< Several buttons held together. */
+} button_gesture_type_t;
+
+/**@brief Gesture event. */
+typedef struct
+{
+    button_gesture_type_t type;     /**< Gesture type. */
+    uint32_t              pins;     /**< Pin bitmask of the button, or of all buttons of a chord. See @ref BUTTON_SCAN_MASK. */
+    uint16_t              repeats;  /**< Number of the repeat, starting at 1. Only for @ref BUTTON_GESTURE_REPEAT. */
+} button_gesture_evt_t;
+
+/**@brief Gesture event handler, called in the TIMER interrupt of @ref button_scan or the application timer interrupt.
+ *
+ * @param[in] p_evt     Gesture.
+ */
+typedef void (*button_gesture_handler_t)(button_gesture_evt_t const * p_evt);
+
+/**@brief Function for initializing the buttons and the gesture detection.
+ *
+ * @details Initializes @ref button_scan. Requires an initialized app_timer.
+ *
+ * @param[in] p_pins        Button pins.
+ * @param[in] count         Number of pins.
+ * @param[in] active_low    True if a pressed button pulls its pin low.
+ * @param[in] handler       Gesture handler.
+ *
+ * @retval NRF_SUCCESS              The buttons are enabled.
+ * @retval NRF_ERROR_INVALID_PARAM  More than @ref BUTTON_GESTURE_MAX_COUNT buttons.
+ * @return Errors from @ref button_scan_init and @ref app_timer_create.
+ */
+ret_code_t button_gesture_init(uint8_t const * p_pins, uint8_t count, bool active_low,
+                               button_gesture_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTON_GESTURE_H__
+
+/** @} */
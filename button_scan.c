@@ -0,0 +1,219 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+
+#include "button_scan.h"
+#include "latency.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_gpio.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+#include "nrf.h"
+
+static const nrf_drv_timer_t    m_timer = NRF_DRV_TIMER_INSTANCE(BUTTON_SCAN_TIMER);
+
+static button_scan_handler_t    m_handler;
+static uint32_t                 m_mask;         // Pins of all buttons.
+static uint32_t                 m_invert;       // Pins read as 1 while released.
+static uint32_t                 m_port;         // Port levels at the last event, button pins only.
+static volatile uint32_t        m_state;        // Pins pressed at the last event.
+static nrf_ppi_channel_t        m_ppi_restart;
+static button_scan_stats_t      m_stats;
+
+
+// Every pin senses the level it does not have, so the PORT event fires on
+// the next change of any of them.
+static void sense_set(uint32_t pins, uint32_t port)
+{
+    while (pins != 0)
+    {
+        uint32_t pin = 31 - __CLZ(pins);
+
+        nrf_gpio_cfg_sense_set(pin, (port & BUTTON_SCAN_MASK(pin)) ? NRF_GPIO_PIN_SENSE_LOW
+                                                                   : NRF_GPIO_PIN_SENSE_HIGH);
+        pins &= ~BUTTON_SCAN_MASK(pin);
+    }
+}
+
+
+// A pin that changed after the port was read keeps DETECT high, which hides
+// the edges of every other pin from the PORT event. Such a change restarts
+// the quiet period from software instead.
+static void detect_check(void)
+{
+    if (((nrf_gpio_port_in_read(NRF_GPIO) & m_mask) ^ m_port) != 0)
+    {
+        nrf_drv_timer_clear(&m_timer);
+        nrf_drv_timer_resume(&m_timer);
+    }
+}
+
+
+// The inputs have been quiet for BUTTON_SCAN_QUIET_US since the last edge.
+static void timer_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    uint32_t port;
+    uint32_t changed;
+    uint32_t state;
+
+    UNUSED_PARAMETER(p_context);
+
+    if (event_type != NRF_TIMER_EVENT_COMPARE0)
+    {
+        return;
+    }
+
+    m_stats.wakeups++;
+
+    port    = nrf_gpio_port_in_read(NRF_GPIO) & m_mask;
+    changed = port ^ m_port;
+    if (changed == 0)
+    {
+        // Bounce that settled back to the old level.
+        detect_check();
+        latency_input(false);
+        return;
+    }
+
+    m_port = port;
+    sense_set(changed, port);
+    detect_check();
+
+    state   = port ^ m_invert;
+    changed = state ^ m_state;
+    m_state = state;
+    m_stats.changes++;
+
+    // The first edge was timestamped in hardware, see latency.h.
+    latency_input((changed & state) != 0);
+
+    m_handler(changed & state, changed & ~state, state);
+}
+
+
+ret_code_t button_scan_init(uint8_t const * p_pins, uint8_t count, bool active_low, button_scan_handler_t handler)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_pins);
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    if (count > BUTTON_SCAN_MAX_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_handler = handler;
+    m_mask    = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (p_pins[i] >= NUMBER_OF_PINS)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+        m_mask |= BUTTON_SCAN_MASK(p_pins[i]);
+    }
+    m_invert = active_low ? m_mask : 0;
+
+    // The quiet period timer stops itself at the compare, and only then interrupts.
+    nrf_drv_timer_config_t timer_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_cfg.frequency          = NRF_TIMER_FREQ_1MHz;
+    timer_cfg.mode               = NRF_TIMER_MODE_TIMER;
+    timer_cfg.bit_width          = NRF_TIMER_BIT_WIDTH_32;
+    timer_cfg.interrupt_priority = BUTTON_SCAN_IRQ_PRIORITY;
+
+    err_code = nrf_drv_timer_init(&m_timer, &timer_cfg, timer_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    nrf_drv_timer_extended_compare(&m_timer, NRF_TIMER_CC_CHANNEL0, BUTTON_SCAN_QUIET_US,
+                                   NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK | NRF_TIMER_SHORT_COMPARE0_STOP_MASK,
+                                   true);
+
+    err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return err_code;
+    }
+
+    // Every edge, bounce included, restarts the quiet period in hardware.
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_restart);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_restart,
+                                          (uint32_t)&NRF_GPIOTE->EVENTS_PORT,
+                                          nrf_drv_timer_task_address_get(&m_timer, NRF_TIMER_TASK_CLEAR));
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_restart,
+                                               nrf_drv_timer_task_address_get(&m_timer, NRF_TIMER_TASK_START));
+    VERIFY_SUCCESS(err_code);
+
+    CRITICAL_REGION_ENTER();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        nrf_gpio_cfg_sense_input(p_pins[i], active_low ? NRF_GPIO_PIN_PULLUP : NRF_GPIO_PIN_PULLDOWN,
+                                 NRF_GPIO_PIN_NOSENSE);
+    }
+    m_port  = nrf_gpio_port_in_read(NRF_GPIO) & m_mask;
+    m_state = m_port ^ m_invert;
+    sense_set(m_mask, m_port);
+    CRITICAL_REGION_EXIT();
+
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_restart);
+    VERIFY_SUCCESS(err_code);
+
+    detect_check();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t button_scan_state_get(void)
+{
+    return m_state;
+}
+
+
+void button_scan_stats_get(button_scan_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
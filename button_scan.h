@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup button_scan Button scanner
+ * @{
+ * @brief Debounced button inputs on the GPIOTE PORT event, without CPU work per bounce.
+ *
+ * @details Every button pin senses the level it does not have, so any change
+ *          sets the shared PORT event of GPIOTE. No GPIOTE channel is used, and
+ *          the number of buttons is only limited by the port width.
+ *
+ *          The PORT event does not interrupt. Through PPI it clears and starts
+ *          TIMER @ref BUTTON_SCAN_TIMER, so every edge, bounce included,
+ *          restarts a quiet period in hardware. Only when the inputs have been
+ *          stable for @ref BUTTON_SCAN_QUIET_US does the compare event stop
+ *          the timer and raise the one interrupt of the press or release.
+ *          Contact bounce never reaches the CPU.
+ *
+ *          The interrupt reads the whole port with a single register read,
+ *          flips the sense of the pins that changed and compares the buttons
+ *          with the previous state. All presses and releases are reported
+ *          together as pin bitmasks, in the TIMER interrupt.
+ */
+
+#ifndef BUTTON_SCAN_H__
+#define BUTTON_SCAN_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "app_util_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUTTON_SCAN_MAX_COUNT   32      /**< Buttons on the one GPIO port. */
+#define BUTTON_SCAN_TIMER       2       /**< TIMER instance measuring the quiet period. */
+#define BUTTON_SCAN_QUIET_US    10000   /**< Time without edges before the inputs are read. */
+#define BUTTON_SCAN_IRQ_PRIORITY APP_IRQ_PRIORITY_LOWEST    /**< Priority of the TIMER interrupt that calls the handler. */
+
+/**@brief Macro for the bitmask of a button pin. */
+#define BUTTON_SCAN_MASK(pin)   (1UL << (pin))
+
+/**@brief Button statistics. */
+typedef struct
+{
+    uint32_t wakeups;       /**< Number of quiet period interrupts. */
+    uint32_t changes;       /**< Number of interrupts that changed the button state. Bounce that settled on the old level does not count. */
+} button_scan_stats_t;
+
+/**@brief Button event handler, called in the TIMER interrupt.
+ *
+ * @param[in] pressed   Bitmask of the pins pressed since the previous event.
+ * @param[in] released  Bitmask of the pins released since the previous event.
+ * @param[in] state     Bitmask of the pins now pressed.
+ */
+typedef void (*button_scan_handler_t)(uint32_t pressed, uint32_t released, uint32_t state);
+
+/**@brief Function for initializing the buttons and enabling their events.
+ *
+ * @details Buttons already pressed are part of the initial state and not
+ *          reported. Uses TIMER @ref BUTTON_SCAN_TIMER and one PPI channel.
+ *
+ * @param[in] p_pins        Button pins.
+ * @param[in] count         Number of pins.
+ * @param[in] active_low    True if a pressed button pulls its pin low. The pins get a pull-up, else a pull-down.
+ * @param[in] handler       Event handler.
+ *
+ * @retval NRF_SUCCESS              The buttons are enabled.
+ * @retval NRF_ERROR_INVALID_PARAM  Too many buttons or an invalid pin.
+ * @return Errors from the TIMER and PPI drivers.
+ */
+ret_code_t button_scan_init(uint8_t const * p_pins, uint8_t count, bool active_low, button_scan_handler_t handler);
+
+/**@brief Function for getting the bitmask of the pins pressed at the last event. */
+uint32_t button_scan_state_get(void);
+
+/**@brief Function for reading the statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void button_scan_stats_get(button_scan_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTON_SCAN_H__
+
+/** @} */
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "defer.h"
+#include "app_scheduler.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+
+typedef struct
+{
+    uint32_t        posted;     // RTC ticks.
+    defer_handler_t handler;
+    uint8_t         data[DEFER_DATA_SIZE];
+} defer_evt_t;
+
+#define DEFER_HEADER_SIZE   offsetof(defer_evt_t, data)
+
+static uint32_t m_sched_buf[CEIL_DIV(APP_SCHED_BUF_SIZE(sizeof(defer_evt_t), DEFER_QUEUE_SIZE), sizeof(uint32_t))];
+
+static defer_stats_t    m_stats;
+static uint32_t         m_depth;            // Events queued and not yet started.
+static uint32_t         m_executed;         // Events started since the statistics were cleared.
+static uint64_t         m_latency_sum;      // RTC ticks.
+static uint32_t         m_max_latency;      // RTC ticks.
+
+
+static void dispatch(void * p_event_data, uint16_t event_size)
+{
+    defer_evt_t const * p_evt   = p_event_data;
+    uint32_t            latency = app_timer_cnt_diff_compute(app_timer_cnt_get(), p_evt->posted);
+
+    CRITICAL_REGION_ENTER();
+    m_depth--;
+    m_executed++;
+    m_latency_sum += latency;
+    if (latency > m_max_latency)
+    {
+        m_max_latency = latency;
+    }
+    CRITICAL_REGION_EXIT();
+
+    p_evt->handler(p_evt->data, event_size - DEFER_HEADER_SIZE);
+}
+
+
+ret_code_t defer_init(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_depth       = 0;
+    m_executed    = 0;
+    m_latency_sum = 0;
+    m_max_latency = 0;
+
+    return app_sched_init(sizeof(defer_evt_t), DEFER_QUEUE_SIZE, m_sched_buf);
+}
+
+
+ret_code_t defer_put(defer_handler_t handler, void const * p_data, uint16_t size)
+{
+    ret_code_t  err_code;
+    defer_evt_t evt;
+
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    if (size > DEFER_DATA_SIZE)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    evt.handler = handler;
+    if (size != 0)
+    {
+        memcpy(evt.data, p_data, size);
+    }
+
+    // The stamp and the counters must match the order of the queue.
+    CRITICAL_REGION_ENTER();
+    evt.posted = app_timer_cnt_get();
+    err_code   = app_sched_event_put(&evt, DEFER_HEADER_SIZE + size, dispatch);
+    m_stats.posted++;
+    if (err_code == NRF_SUCCESS)
+    {
+        m_depth++;
+        if (m_depth > m_stats.max_depth)
+        {
+            m_stats.max_depth = m_depth;
+        }
+    }
+    else
+    {
+        m_stats.dropped++;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+void defer_execute(void)
+{
+    app_sched_execute();
+}
+
+
+void defer_stats_get(defer_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    p_stats->max_latency_us = (uint32_t)(((uint64_t)m_max_latency * 1000000) / APP_TIMER_CLOCK_FREQ);
+    p_stats->avg_latency_us = (m_executed != 0) ?
+                              (uint32_t)((m_latency_sum * 1000000) / ((uint64_t)m_executed * APP_TIMER_CLOCK_FREQ)) : 0;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.max_depth = m_depth;
+    m_executed        = 0;
+    m_latency_sum     = 0;
+    m_max_latency     = 0;
+    CRITICAL_REGION_EXIT();
+}
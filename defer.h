@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup defer Deferred execution
+ * @{
+ * @brief Run-to-completion event queue on app_scheduler, with latency statistics.
+ *
+ * @details Interrupt handlers post an event with a copy of its data and
+ *          return. The main loop runs the handlers of all queued events one
+ *          after the other in thread mode, so a long action never blocks an
+ *          interrupt, and the interrupts of UART, timers and PWM keep running
+ *          while it executes.
+ *
+ *          Every event is stamped with the RTC counter when it is posted. The
+ *          queue depth after each post and the delay until the handler starts
+ *          are recorded in @ref defer_stats_t.
+ *
+ *          Handlers run in thread mode and can be preempted by any interrupt,
+ *          so they may only call functions that allow it.
+ */
+
+#ifndef DEFER_H__
+#define DEFER_H__
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DEFER_DATA_SIZE         16      /**< Largest event data. */
+#define DEFER_QUEUE_SIZE        8       /**< Number of queued events. */
+
+/**@brief Deferred event handler, called from @ref defer_execute.
+ *
+ * @param[in] p_data    Copy of the posted data.
+ * @param[in] size      Data size.
+ */
+typedef void (*defer_handler_t)(void const * p_data, uint16_t size);
+
+/**@brief Queue statistics. */
+typedef struct
+{
+    uint32_t posted;            /**< Number of posted events. */
+    uint32_t dropped;           /**< Number of events lost because the queue was full. */
+    uint32_t max_depth;         /**< Most events queued at once. */
+    uint32_t max_latency_us;    /**< Longest delay from post to handler start, at the 30.5 us resolution of the RTC. */
+    uint32_t avg_latency_us;    /**< Average delay from post to handler start. */
+} defer_stats_t;
+
+/**@brief Function for initializing the queue.
+ *
+ * @retval NRF_SUCCESS  The queue is ready.
+ * @return Errors from @ref app_sched_init.
+ */
+ret_code_t defer_init(void);
+
+/**@brief Function for posting an event. Can be called from any context.
+ *
+ * @param[in] handler   Handler to run.
+ * @param[in] p_data    Event data, copied into the queue. Can be NULL if @p size is 0.
+ * @param[in] size      Data size, at most @ref DEFER_DATA_SIZE.
+ *
+ * @retval NRF_SUCCESS              The event is queued.
+ * @retval NRF_ERROR_INVALID_LENGTH The data is too long.
+ * @retval NRF_ERROR_NO_MEM         The queue is full. The event is counted as dropped.
+ */
+ret_code_t defer_put(defer_handler_t handler, void const * p_data, uint16_t size);
+
+/**@brief Function for running all queued events. Call from the main loop. */
+void defer_execute(void);
+
+/**@brief Function for reading and clearing the statistics.
+ *
+ * @param[out] p_stats  Statistics since the previous call.
+ */
+void defer_stats_get(defer_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DEFER_H__
+
+/** @} */
@@ -0,0 +1,263 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "latency.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+#include "nrf.h"
+
+typedef enum
+{
+    PROBE_IDLE,
+    PROBE_STARTED,      // Edge seen.
+    PROBE_ARMED         // The action changes the output.
+} probe_state_t;
+
+typedef struct
+{
+    probe_state_t   state;
+    uint32_t        start;      // Timestamp of the edge.
+    latency_stats_t stats;
+    uint64_t        sum;
+} probe_t;
+
+static const nrf_drv_timer_t m_timer = NRF_DRV_TIMER_INSTANCE(LATENCY_TIMER);
+
+static probe_t              m_probes[LATENCY_PATH_COUNT];
+static nrf_ppi_channel_t    m_ppi_edge;
+static nrf_ppi_channel_group_t m_ppi_edge_group;    // Holds m_ppi_edge, disabled by the first edge.
+static nrf_ppi_channel_t    m_ppi_boundary;
+
+
+static void stats_clear(probe_t * p_probe)
+{
+    memset(&p_probe->stats, 0, sizeof(p_probe->stats));
+    p_probe->stats.min_us = UINT32_MAX;
+    p_probe->sum          = 0;
+}
+
+
+static uint32_t bin_get(uint32_t latency_us)
+{
+    uint32_t bin = 0;
+
+    for (uint32_t edge = LATENCY_HIST_BASE_US; (latency_us >= edge) && (bin < LATENCY_HIST_BINS - 1); edge <<= 1)
+    {
+        bin++;
+    }
+
+    return bin;
+}
+
+
+static void timer_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    // No interrupts are enabled on the timestamp timer.
+    UNUSED_PARAMETER(event_type);
+    UNUSED_PARAMETER(p_context);
+}
+
+
+ret_code_t latency_init(void)
+{
+    ret_code_t err_code;
+
+    for (uint32_t i = 0; i < LATENCY_PATH_COUNT; i++)
+    {
+        m_probes[i].state = PROBE_IDLE;
+        stats_clear(&m_probes[i]);
+    }
+
+    nrf_drv_timer_config_t timer_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_cfg.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_cfg.mode      = NRF_TIMER_MODE_TIMER;
+    timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    err_code = nrf_drv_timer_init(&m_timer, &timer_cfg, timer_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return err_code;
+    }
+
+    // Timestamp the first button edge in CC0 and every servo period boundary
+    // in CC1. The edge channel turns itself off, the bounce that follows
+    // must not overwrite CC0.
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_edge);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_group_alloc(&m_ppi_edge_group);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_edge,
+                                          (uint32_t)&NRF_GPIOTE->EVENTS_PORT,
+                                          nrf_drv_timer_capture_task_address_get(&m_timer,
+                                                                                 NRF_TIMER_CC_CHANNEL0));
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_edge,
+                                               nrf_drv_ppi_task_addr_group_disable_get(m_ppi_edge_group));
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_include_in_group(m_ppi_edge, m_ppi_edge_group);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_group_enable(m_ppi_edge_group);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_boundary);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_boundary,
+                                          (uint32_t)&NRF_PWM0->EVENTS_PWMPERIODEND,
+                                          nrf_drv_timer_capture_task_address_get(&m_timer,
+                                                                                 NRF_TIMER_CC_CHANNEL1));
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_boundary);
+    VERIFY_SUCCESS(err_code);
+
+    nrf_drv_timer_enable(&m_timer);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t latency_now(void)
+{
+    uint32_t now;
+
+    // CC2 is shared by all contexts.
+    CRITICAL_REGION_ENTER();
+    now = nrf_drv_timer_capture(&m_timer, NRF_TIMER_CC_CHANNEL2);
+    CRITICAL_REGION_EXIT();
+
+    return now;
+}
+
+
+uint32_t latency_boundary_get(void)
+{
+    return nrf_drv_timer_capture_get(&m_timer, NRF_TIMER_CC_CHANNEL1);
+}
+
+
+void latency_input(bool start)
+{
+    uint32_t edge = nrf_drv_timer_capture_get(&m_timer, NRF_TIMER_CC_CHANNEL0);
+
+    (void)nrf_drv_ppi_group_enable(m_ppi_edge_group);
+
+    if (!start)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    for (uint32_t i = 0; i < LATENCY_PATH_COUNT; i++)
+    {
+        m_probes[i].state = PROBE_STARTED;
+        m_probes[i].start = edge;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+void latency_arm(latency_path_t path)
+{
+    if (path >= LATENCY_PATH_COUNT)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    if (m_probes[path].state == PROBE_STARTED)
+    {
+        m_probes[path].state = PROBE_ARMED;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+void latency_output(latency_path_t path, uint32_t timestamp)
+{
+    if (path >= LATENCY_PATH_COUNT)
+    {
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    probe_t * p_probe = &m_probes[path];
+
+    if (p_probe->state == PROBE_ARMED)
+    {
+        uint32_t latency = timestamp - p_probe->start;
+
+        p_probe->state = PROBE_IDLE;
+        p_probe->stats.count++;
+        p_probe->stats.min_us = MIN(p_probe->stats.min_us, latency);
+        p_probe->stats.max_us = MAX(p_probe->stats.max_us, latency);
+        p_probe->stats.hist[bin_get(latency)]++;
+        p_probe->sum += latency;
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+void latency_stats_get(latency_path_t path, latency_stats_t * p_stats)
+{
+    if (path >= LATENCY_PATH_COUNT)
+    {
+        memset(p_stats, 0, sizeof(*p_stats));
+        return;
+    }
+
+    CRITICAL_REGION_ENTER();
+    probe_t * p_probe = &m_probes[path];
+
+    *p_stats        = p_probe->stats;
+    p_stats->avg_us = (p_probe->stats.count != 0) ? (uint32_t)(p_probe->sum / p_probe->stats.count) : 0;
+    if (p_probe->stats.count == 0)
+    {
+        p_stats->min_us = 0;
+    }
+    stats_clear(p_probe);
+    CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup latency Input to actuation latency probes
+ * @{
+ * @brief Hardware timestamps from a button edge to the output change it causes.
+ *
+ * @details A TIMER runs freely at 1 MHz. Two PPI channels capture it without
+ *          any CPU involvement:
+ *
+ *          - CC0 on the GPIOTE PORT event, i.e. the edge of a button. The
+ *            same event disables the capture through a PPI group, so CC0
+ *            holds the first edge of a bounce burst until it is read.
+ *          - CC1 on the period end of PWM0, i.e. the boundary at which new
+ *            servo pulses take effect.
+ *
+ *          A probe per path measures from the edge to the actuation:
+ *
+ *          1. @ref latency_input takes the edge timestamp when the debounced
+ *             change is seen, and starts all paths on a press.
+ *          2. @ref latency_arm is called by the action that will change the
+ *             output of a path, so outputs changed for other reasons are not
+ *             counted.
+ *          3. @ref latency_output gives the time the output changed. The first
+ *             change after the arm completes the measurement.
+ *
+ *          Every path keeps the minimum, average and maximum and a histogram
+ *          with bins that double in width, see @ref LATENCY_HIST_BINS.
+ */
+
+#ifndef LATENCY_H__
+#define LATENCY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LATENCY_TIMER           0       /**< TIMER instance of the timestamps. */
+#define LATENCY_HIST_BINS       10      /**< Bin 0 holds latencies below @ref LATENCY_HIST_BASE_US, bin n from 2^(n-1) to 2^n times that, the last bin everything above. */
+#define LATENCY_HIST_BASE_US    1024    /**< Upper edge of histogram bin 0. */
+
+/**@brief Measured paths. */
+typedef enum
+{
+    LATENCY_PATH_SERVO,     /**< Button edge to the first servo period with a new pulse. */
+    LATENCY_PATH_LED,       /**< Button edge to the start of a new LED pattern. */
+    LATENCY_PATH_COUNT
+} latency_path_t;
+
+/**@brief Statistics of a path, in microseconds. */
+typedef struct
+{
+    uint32_t count;                     /**< Number of measurements. */
+    uint32_t min_us;                    /**< Shortest latency. */
+    uint32_t avg_us;                    /**< Average latency. */
+    uint32_t max_us;                    /**< Longest latency. */
+    uint32_t hist[LATENCY_HIST_BINS];   /**< Histogram. */
+} latency_stats_t;
+
+/**@brief Function for starting the timestamp TIMER and the capture PPI channels.
+ *
+ * @retval NRF_SUCCESS  The probes are running.
+ * @return Errors from the TIMER and PPI drivers.
+ */
+ret_code_t latency_init(void);
+
+/**@brief Function for getting the current timestamp in microseconds. */
+uint32_t latency_now(void);
+
+/**@brief Function for getting the timestamp of the last PWM0 period end. */
+uint32_t latency_boundary_get(void);
+
+/**@brief Function for taking the first edge of a button change and rearming the capture.
+ *
+ * @param[in] start     True to start all paths at the edge, for a press.
+ */
+void latency_input(bool start);
+
+/**@brief Function for marking that an output of a path is about to change because of the input. */
+void latency_arm(latency_path_t path);
+
+/**@brief Function for completing a measurement. Ignored unless the path is armed.
+ *
+ * @param[in] path          Path.
+ * @param[in] timestamp     Time the output changed, see @ref latency_now.
+ */
+void latency_output(latency_path_t path, uint32_t timestamp);
+
+/**@brief Function for reading and clearing the statistics of a path.
+ *
+ * @param[in]  path     Path.
+ * @param[out] p_stats  Statistics since the previous call.
+ */
+void latency_stats_get(latency_path_t path, latency_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_H__
+
+/** @} */
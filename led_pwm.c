@@ -0,0 +1,380 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "led_pwm.h"
+#include "servo.h"
+#include "nrf_drv_pwm.h"
+#include "boards.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+
+#if SERVO_INSTANCE_COUNT > LED_PWM_INSTANCE
+#error "The servo bank uses the PWM instance of the LED engine."
+#endif
+
+#define LED_PWM_TOP         (1000000 / LED_PWM_FREQ_HZ)     // Counter top at the 1 MHz base clock.
+#define LED_PWM_LEVEL_MAX   100
+
+#if (LED_PWM_DITHER_PERIODS < 1) || (LED_PWM_DITHER_PERIODS > 16) || \
+    ((LED_PWM_DITHER_PERIODS & (LED_PWM_DITHER_PERIODS - 1)) != 0)
+#error "LED_PWM_DITHER_PERIODS must be a power of two up to 16."
+#endif
+
+#if LEDS_ACTIVE_STATE
+#define LED_PWM_POLARITY    0x8000                      // High from the start of the period until the compare value.
+#define LED_PWM_PIN_FLAGS   0
+#else
+#define LED_PWM_POLARITY    0                           // Low from the start of the period until the compare value.
+#define LED_PWM_PIN_FLAGS   NRF_DRV_PWM_PIN_INVERTED    // Idle high, LEDs off while stopped.
+#endif
+
+static nrf_drv_pwm_t const          m_pwm = NRF_DRV_PWM_INSTANCE(LED_PWM_INSTANCE);
+static uint16_t                     m_seq[LED_PWM_MAX_STEPS * NRF_PWM_CHANNEL_COUNT];  // Individual values, LED_1 to LED_4.
+static bool                         m_initialized;
+static bool                         m_busy;                                             // A call to led_pwm_play() is running, or the engine is claimed.
+static led_pwm_info_t               m_info;                                             // Layout of the sequence being played.
+
+// Order in which the periods of a dither pattern get the extra tick: bit
+// reversed indices, so the extra ticks of any fraction are spread evenly.
+// The first d entries, shifted right by 4 - log2(d), give the order for a
+// pattern of d periods.
+static uint8_t const m_dither_rank[16] = { 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15 };
+
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0)
+    {
+        uint32_t t = a % b;
+
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+
+static uint32_t log2_get(uint32_t value)
+{
+    uint32_t result = 0;
+
+    while (value > 1)
+    {
+        value >>= 1;
+        result++;
+    }
+
+    return result;
+}
+
+
+// Gamma 2 makes the ramps look linear. The compare value is computed in
+// 1/dither ticks and the fraction is spread over dither consecutive PWM
+// periods, so the low levels that round to a few ticks still fade smoothly.
+// The group of dither entries is repeated to fill count entries.
+static void compare_fill(uint16_t * p_entry, int32_t level, uint32_t dither, uint32_t count)
+{
+    uint32_t ticks = (LED_PWM_TOP * dither * level * level + LED_PWM_LEVEL_MAX * LED_PWM_LEVEL_MAX / 2) /
+                     (LED_PWM_LEVEL_MAX * LED_PWM_LEVEL_MAX);
+    uint32_t base  = ticks / dither;
+    uint32_t frac  = ticks % dither;
+    uint32_t shift = 4 - log2_get(dither);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t extra = ((uint32_t)(m_dither_rank[k & (dither - 1)] >> shift) < frac) ? 1 : 0;
+
+        p_entry[k * NRF_PWM_CHANNEL_COUNT] = (uint16_t)(base + extra) | LED_PWM_POLARITY;
+    }
+}
+
+
+// Writes one cycle of a pattern into the column of an LED and returns its
+// length in steps, at most max_length. Every step takes count entries.
+static uint32_t column_fill(uint16_t * p_column, led_pwm_pattern_t const * p_pattern, uint32_t step_ms,
+                            uint32_t dither, uint32_t count, uint32_t max_length)
+{
+    uint32_t length = 0;
+
+    if (p_pattern->count == 0)
+    {
+        compare_fill(p_column, 0, dither, count);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < p_pattern->count; i++)
+    {
+        led_pwm_step_t const * p_step  = &p_pattern->p_steps[i];
+        int32_t                entries = p_step->duration_ms / step_ms;
+
+        for (int32_t j = 0; (j < entries) && (length < max_length); j++)
+        {
+            int32_t level = p_step->from + ((p_step->to - p_step->from) * j) / entries;
+
+            compare_fill(&p_column[length * count * NRF_PWM_CHANNEL_COUNT], level, dither, count);
+            length++;
+        }
+    }
+
+    return length;
+}
+
+
+ret_code_t led_pwm_init(void)
+{
+    ret_code_t err_code;
+
+    nrf_drv_pwm_config_t const config =
+    {
+        .output_pins  =
+        {
+            LED_1 | LED_PWM_PIN_FLAGS,
+            LED_2 | LED_PWM_PIN_FLAGS,
+            LED_3 | LED_PWM_PIN_FLAGS,
+            LED_4 | LED_PWM_PIN_FLAGS
+        },
+        .irq_priority = APP_IRQ_PRIORITY_LOWEST,
+        .base_clock   = NRF_PWM_CLK_1MHz,
+        .count_mode   = NRF_PWM_MODE_UP,
+        .top_value    = LED_PWM_TOP,
+        .load_mode    = NRF_PWM_LOAD_INDIVIDUAL,
+        .step_mode    = NRF_PWM_STEP_AUTO
+    };
+
+    // No handler, the patterns play without interrupts.
+    err_code = nrf_drv_pwm_init(&m_pwm, &config, NULL);
+    VERIFY_SUCCESS(err_code);
+
+    m_initialized = true;
+
+    return NRF_SUCCESS;
+}
+
+
+static bool busy_set(void)
+{
+    bool busy;
+
+    CRITICAL_REGION_ENTER();
+    busy   = m_busy;
+    m_busy = true;
+    CRITICAL_REGION_EXIT();
+
+    return busy;
+}
+
+
+static ret_code_t patterns_play(led_pwm_pattern_t const * p_patterns, uint16_t loops)
+{
+    uint32_t step_ms = 0;
+    uint32_t length  = 1;
+    uint32_t periods;
+    uint32_t dither;
+    uint32_t count;
+    uint32_t refresh;
+    uint16_t plays;
+    bool     ramp    = false;
+
+    // The step time must divide every duration.
+    for (uint32_t led = 0; led < LED_PWM_LED_COUNT; led++)
+    {
+        for (uint32_t i = 0; i < p_patterns[led].count; i++)
+        {
+            led_pwm_step_t const * p_step = &p_patterns[led].p_steps[i];
+
+            if ((p_step->from > LED_PWM_LEVEL_MAX) || (p_step->to > LED_PWM_LEVEL_MAX) ||
+                (p_step->duration_ms == 0))
+            {
+                return NRF_ERROR_INVALID_PARAM;
+            }
+            step_ms  = gcd(step_ms, p_step->duration_ms);
+            ramp    |= (p_step->from != p_step->to);
+        }
+    }
+    if (ramp)
+    {
+        step_ms = gcd(step_ms, LED_PWM_RAMP_STEP_MS);
+    }
+
+    // The patterns repeat together after the least common multiple of their lengths.
+    for (uint32_t led = 0; (led < LED_PWM_LED_COUNT) && (step_ms != 0); led++)
+    {
+        uint32_t cycle = 0;
+
+        for (uint32_t i = 0; i < p_patterns[led].count; i++)
+        {
+            cycle += p_patterns[led].p_steps[i].duration_ms / step_ms;
+        }
+        if (cycle > LED_PWM_MAX_STEPS)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+        if (cycle != 0)
+        {
+            length = (length / gcd(length, cycle)) * cycle;
+        }
+        if (length > LED_PWM_MAX_STEPS)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+    }
+
+    // The sequence can only be rewritten while it is not played.
+    (void)nrf_drv_pwm_stop(&m_pwm, true);
+
+    if (step_ms == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    // The dither entries must change every PWM period, so a dithered sequence
+    // plays with REFRESH 0. When the patterns are constant the group of dither
+    // entries is looped, otherwise every period of a step needs its own entry.
+    // Without room for that the step is one entry held by REFRESH, undithered.
+    periods = (step_ms * LED_PWM_FREQ_HZ) / 1000;
+    dither  = LED_PWM_DITHER_PERIODS;
+    while ((dither > 1) && ((periods % dither) != 0))
+    {
+        dither >>= 1;
+    }
+
+    if ((dither > 1) && (length == 1) && ((uint32_t)loops * (periods / dither) <= UINT16_MAX))
+    {
+        count = dither;
+    }
+    else if ((dither > 1) && (length * periods <= LED_PWM_MAX_STEPS))
+    {
+        count = periods;
+    }
+    else
+    {
+        dither = 1;
+        count  = 1;
+    }
+
+    // A play of the sequence covers count * (refresh + 1) of the periods of one cycle.
+    refresh = (count == 1) ? periods - 1 : 0;
+    plays   = (uint16_t)(loops * (periods / (count * (refresh + 1))));
+
+    for (uint32_t led = 0; led < LED_PWM_LED_COUNT; led++)
+    {
+        uint16_t * p_column = &m_seq[led];
+        uint32_t   cycle    = column_fill(p_column, &p_patterns[led], step_ms, dither, count, length) * count;
+
+        for (uint32_t i = cycle; i < length * count; i++)
+        {
+            p_column[i * NRF_PWM_CHANNEL_COUNT] = p_column[(i - cycle) * NRF_PWM_CHANNEL_COUNT];
+        }
+    }
+
+    nrf_pwm_sequence_t const seq =
+    {
+        .values.p_raw        = m_seq,
+        .length              = (uint16_t)(length * count * NRF_PWM_CHANNEL_COUNT),
+        .repeats             = refresh,
+        .end_delay           = 0
+    };
+
+    CRITICAL_REGION_ENTER();
+    m_info.steps          = (uint16_t)length;
+    m_info.entries        = (uint16_t)(length * count);
+    m_info.refresh        = refresh;
+    m_info.dither_periods = (uint8_t)dither;
+    CRITICAL_REGION_EXIT();
+
+    if (loops == 0)
+    {
+        (void)nrf_drv_pwm_simple_playback(&m_pwm, &seq, 1, NRF_DRV_PWM_FLAG_LOOP);
+    }
+    else
+    {
+        (void)nrf_drv_pwm_simple_playback(&m_pwm, &seq, plays, NRF_DRV_PWM_FLAG_STOP);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t led_pwm_play(led_pwm_pattern_t const p_patterns[LED_PWM_LED_COUNT], uint16_t loops)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_patterns);
+
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // The sequence buffer is shared, a call from an interrupt must not
+    // rewrite it under a call from thread mode.
+    if (busy_set())
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    err_code = patterns_play(p_patterns, loops);
+    m_busy   = false;
+
+    return err_code;
+}
+
+
+ret_code_t led_pwm_claim(void)
+{
+    return busy_set() ? NRF_ERROR_BUSY : NRF_SUCCESS;
+}
+
+
+void led_pwm_release(void)
+{
+    m_busy = false;
+}
+
+
+void led_pwm_info_get(led_pwm_info_t * p_info)
+{
+    CRITICAL_REGION_ENTER();
+    *p_info = m_info;
+    CRITICAL_REGION_EXIT();
+}
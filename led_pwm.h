@@ -0,0 +1,187 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup led_pwm LED pattern engine
+ * @{
+ * @brief Blink, breathe and fade patterns on LED_1 to LED_4, played by the PWM peripheral.
+ *
+ * @details A pattern is a list of steps. Each step ramps linearly from one
+ *          brightness to another over a duration, or holds one brightness when
+ *          both are the same. @ref led_pwm_play compiles the patterns of all
+ *          four LEDs into a single EasyDMA sequence:
+ *
+ *          - The step time is the greatest common divisor of all durations, and
+ *            of @ref LED_PWM_RAMP_STEP_MS when there are ramps. Holds cost one
+ *            entry per step time, so a slow blink is only two entries long.
+ *          - The REFRESH count of the sequence repeats every entry for one step
+ *            time at the @ref LED_PWM_FREQ_HZ PWM frequency.
+ *          - Patterns of different length are repeated up to their least
+ *            common multiple, at most @ref LED_PWM_MAX_STEPS entries.
+ *          - Each step is dithered over up to @ref LED_PWM_DITHER_PERIODS
+ *            consecutive PWM periods. The compare values differ by at most one
+ *            tick and average to the exact gamma corrected value, which gives
+ *            the dim levels a finer resolution than the 1 us counter. The
+ *            value changes every period, so the sequence then plays without
+ *            REFRESH: constant patterns loop the dither group, other patterns
+ *            take one entry per period of every step. When that does not fit
+ *            into @ref LED_PWM_MAX_STEPS the patterns play undithered.
+ *
+ *          The sequence loops in hardware without any interrupts or CPU
+ *          wakeups. Brightness is in percent and is gamma corrected when the
+ *          sequence is compiled.
+ *
+ *          The engine uses PWM instance @ref LED_PWM_INSTANCE, which limits the
+ *          servo bank to the instances below it.
+ */
+
+#ifndef LED_PWM_H__
+#define LED_PWM_H__
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LED_PWM_INSTANCE        2       /**< PWM instance driving the LEDs. */
+#define LED_PWM_LED_COUNT       4       /**< LED_1 to LED_4. */
+#define LED_PWM_FREQ_HZ         1000    /**< PWM frequency. */
+#define LED_PWM_RAMP_STEP_MS    20      /**< Longest brightness step of a ramp. */
+#define LED_PWM_MAX_STEPS       256     /**< Length of the compiled sequence. Costs 8 bytes of RAM per step. */
+
+#ifndef LED_PWM_DITHER_PERIODS
+#define LED_PWM_DITHER_PERIODS  8       /**< Longest dither pattern in PWM periods, a power of two up to 16. 1 disables dithering. */
+#endif
+
+/**@brief Pattern step. */
+typedef struct
+{
+    uint8_t  from;          /**< Brightness at the start of the step, 0 to 100 %. */
+    uint8_t  to;            /**< Brightness at the end of the step, 0 to 100 %. */
+    uint16_t duration_ms;   /**< Duration of the step, at least 1 ms. */
+} led_pwm_step_t;
+
+/**@brief Pattern of one LED. A pattern without steps keeps the LED off. */
+typedef struct
+{
+    led_pwm_step_t const * p_steps;     /**< Steps, only used during @ref led_pwm_play. Change them under @ref led_pwm_claim. */
+    uint8_t                count;       /**< Number of steps. */
+} led_pwm_pattern_t;
+
+/**@brief Layout of the compiled sequence, see @ref led_pwm_info_get. */
+typedef struct
+{
+    uint16_t steps;             /**< Steps in one cycle of the patterns. */
+    uint16_t entries;           /**< Sequence entries per LED. */
+    uint32_t refresh;           /**< Additional PWM periods each entry is held. 0 when dithered. */
+    uint8_t  dither_periods;    /**< PWM periods a level is dithered over. 1 when not dithered. */
+} led_pwm_info_t;
+
+/**@brief Macro for a step holding one brightness. */
+#define LED_PWM_HOLD(level, ms)         { (level), (level), (ms) }
+
+/**@brief Macro for a step ramping between two brightness values. */
+#define LED_PWM_RAMP(from, to, ms)      { (from), (to), (ms) }
+
+/**@brief Macro for the steps of a blink. */
+#define LED_PWM_BLINK(on_ms, off_ms)    { LED_PWM_HOLD(100, (on_ms)), LED_PWM_HOLD(0, (off_ms)) }
+
+/**@brief Macro for the steps of a breathe, fading in and out over a period. */
+#define LED_PWM_BREATHE(period_ms)      { LED_PWM_RAMP(0, 100, (period_ms) / 2), LED_PWM_RAMP(100, 0, (period_ms) / 2) }
+
+/**@brief Function for initializing the engine. All LEDs are off.
+ *
+ * @retval NRF_SUCCESS  The engine is ready.
+ * @return Errors from @ref nrf_drv_pwm_init.
+ */
+ret_code_t led_pwm_init(void);
+
+/**@brief Function for compiling and playing the patterns of all LEDs.
+ *
+ * @details Replaces the patterns being played, all LEDs restart at the first
+ *          step. When no LED has a pattern the PWM is stopped. Can be called
+ *          from any context, but a call that interrupts another one fails.
+ *
+ * @param[in] p_patterns    Pattern of LED_1 to LED_4.
+ * @param[in] loops         Number of times the patterns are played, 0 for forever.
+ *                          Afterwards the LEDs are off.
+ *
+ * @retval NRF_SUCCESS              The patterns are playing.
+ * @retval NRF_ERROR_INVALID_STATE  The engine is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  A brightness is above 100 % or a duration is 0.
+ * @retval NRF_ERROR_NO_MEM         The compiled sequence is longer than @ref LED_PWM_MAX_STEPS.
+ * @retval NRF_ERROR_BUSY           Called while another call was running, or while the engine is claimed.
+ */
+ret_code_t led_pwm_play(led_pwm_pattern_t const p_patterns[LED_PWM_LED_COUNT], uint16_t loops);
+
+/**@brief Function for reading the layout of the last compiled sequence.
+ *
+ * @details Shows whether the patterns are dithered. Patterns stopped by
+ *          @ref led_pwm_play without any steps keep the previous layout.
+ *
+ * @param[out] p_info   Layout.
+ */
+void led_pwm_info_get(led_pwm_info_t * p_info);
+
+/**@brief Function for claiming the engine before changing patterns or their steps.
+ *
+ * @details A call to @ref led_pwm_play reads the steps while it compiles them.
+ *          Patterns that are shared between contexts must only be changed
+ *          while the engine is claimed, and played after @ref led_pwm_release.
+ *
+ * @retval NRF_SUCCESS      The engine is claimed.
+ * @retval NRF_ERROR_BUSY   A call to @ref led_pwm_play is running or the engine is already claimed.
+ *                          Leave the patterns unchanged.
+ */
+ret_code_t led_pwm_claim(void);
+
+/**@brief Function for releasing the engine claimed with @ref led_pwm_claim. */
+void led_pwm_release(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LED_PWM_H__
+
+/** @} */
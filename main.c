@@ -62,11 +62,26 @@
 #include "nrf_drv_uart.h"
 
 // Library header files
+#include "app_error.h"
+#include "sdk_macros.h"
+#include "app_util_platform.h"
 #include "app_timer.h"
-#include "app_button.h"
-#include "app_pwm.h"
 
-#include "app_uart.h"
+// Application modules
+#include "uart_dma.h"
+#include "uart_frame.h"
+#include "uart_baud.h"
+#include "uart_bench.h"
+#include "tlog.h"
+#include "uart_cmd.h"
+#include "servo.h"
+#include "servo_motion.h"
+#include "servo_cal.h"
+#include "led_pwm.h"
+#include "servo_ctrl.h"
+#include "button_gesture.h"
+#include "defer.h"
+#include "latency.h"
 
 // Headers and defines needed by the logging interface
 #include "nrf_log.h"
@@ -76,8 +91,15 @@
 #include "nrf_delay.h"
 #include "nrf_gpio.h"
 
-#define UART_TX_BUF_SIZE                256     /**< UART TX buffer size. */
-#define UART_RX_BUF_SIZE                256     /**< UART RX buffer size. */
+#define SERVO_PIN                       4               /**< Output pin of servo channel 0. */
+#define SERVO_ANGLE_BUTTON_1_DDEG       1350            /**< Servo angle selected by button 1, in 0.1 degree. */
+#define SERVO_ANGLE_BUTTON_2_DDEG       450             /**< Servo angle selected by button 2, in 0.1 degree. */
+#define SERVO_ANGLE_JOG_DDEG            50              /**< Servo step of every repeat while a button is held, in 0.1 degree. */
+
+#define UART_ID_PREFIX                  "[nRF52 DK]: "  /**< Prefix of every message sent with uart_write(). */
+
+/** @brief Macro for sending a string literal prefixed with the board id. The length is computed at compile time. */
+#define UART_PRINT(str)                 uart_write("" str "", sizeof(str) - 1)
 
 // Timer instance
 const nrf_drv_timer_t timer0 = NRF_DRV_TIMER_INSTANCE(0);
@@ -85,13 +107,13 @@ const nrf_drv_timer_t timer0 = NRF_DRV_TIMER_INSTANCE(0);
 // PPI channel
 nrf_ppi_channel_t ppi_channel;
 
-// PMW instance
-APP_PWM_INSTANCE(PWM2, 2);  // Setup a PWM instance with TIMER 2
-
-static volatile int ready_flag = true;
-
-//Application timer instance
-APP_TIMER_DEF(m_led_timer_id);
+// LED patterns, played by the PWM peripheral. LED_1 blinks, LED_2 and LED_3 show the last button.
+static led_pwm_step_t         m_led_blink[] = LED_PWM_BLINK(1000, 1000);
+static led_pwm_step_t         m_led_on[]    = { LED_PWM_HOLD(100, 1000) };  // Same time as the blink, keeps the sequence short.
+static led_pwm_pattern_t      m_led_patterns[LED_PWM_LED_COUNT] =
+{
+    { m_led_blink, ARRAY_SIZE(m_led_blink) },
+};
 
 // Dummy timer event handler that will be used for step 2 and 4, but not step 3.
 void timer_event_handler(nrf_timer_event_t event_type, void * p_context)
@@ -100,7 +122,7 @@ void timer_event_handler(nrf_timer_event_t event_type, void * p_context)
     {
         case NRF_TIMER_EVENT_COMPARE0:
             nrf_drv_gpiote_out_task_trigger(LED_3);
-            NRF_LOG_INFO("Toogle LED3 \r\n");
+            TLOG("Toogle LED3");
             break;
         default:
             // Do nothing.
@@ -211,11 +233,6 @@ static void log_init(void)
     NRF_LOG_DEFAULT_BACKENDS_INIT();
 }
 
-void led_timer_timeout_handler(void)
-{
-    nrf_gpio_pin_toggle(LED_1);
-}
-
 static void application_timer_init(void)
 {
     ret_code_t err_code;
@@ -224,85 +241,157 @@ static void application_timer_init(void)
     err_code = app_timer_init();
     APP_ERROR_CHECK(err_code);
 
-    err_code = app_timer_create(&m_led_timer_id,APP_TIMER_MODE_REPEATED, led_timer_timeout_handler);
+}
+
+static void leds_init(void)
+{
+    ret_code_t err_code;
+
+    // The patterns run in hardware, there is no wakeup per blink.
+    err_code = led_pwm_init();
     APP_ERROR_CHECK(err_code);
 
-    err_code = app_timer_start(m_led_timer_id,APP_TIMER_TICKS(1000),NULL);
+    err_code = led_pwm_play(m_led_patterns, 0);
     APP_ERROR_CHECK(err_code);
+}
 
+/** @brief Function for lighting one of LED_2 and LED_3 to show the last button pressed. */
+static void led_button_show(uint8_t button)
+{
+    led_pwm_pattern_t const on  = { m_led_on, ARRAY_SIZE(m_led_on) };
+    led_pwm_pattern_t const off = { NULL, 0 };
+
+    // Never fails in thread mode, cmd_timer() runs to the end before it returns.
+    APP_ERROR_CHECK(led_pwm_claim());
+    m_led_patterns[1] = (button == 1) ? on : off;
+    m_led_patterns[2] = (button == 2) ? on : off;
+    led_pwm_release();
+
+    latency_arm(LATENCY_PATH_LED);
+    APP_ERROR_CHECK(led_pwm_play(m_led_patterns, 0));
+    latency_output(LATENCY_PATH_LED, latency_now());
 }
 
-void button_handler(uint8_t pin_no, uint8_t button_action)
+static int16_t m_servo_angle = (SERVO_CAL_ANGLE_MIN_DDEG + SERVO_CAL_ANGLE_MAX_DDEG) / 2;  /**< Last angle selected with the buttons. */
+
+/** @brief Function for moving servo channel 0 to an angle, unless it is under closed-loop control. */
+static void servo_button_move(int32_t angle_ddeg)
 {
-    NRF_LOG_INFO("Button press detected \r\n");
-    if(pin_no == BUTTON_1 && button_action == APP_BUTTON_PUSH)
+    uint16_t pulse_us;
+
+    if (servo_ctrl_running())
     {
-        NRF_LOG_INFO("Button 1 pressed \r\n");
-        nrf_drv_gpiote_out_task_trigger(LED_1);
-        APP_ERROR_CHECK(app_pwm_channel_duty_set(&PWM2, 0, 10));
-        ready_flag = false;
-         nrf_delay_ms(1000);
-        while(!ready_flag){APP_ERROR_CHECK(app_pwm_channel_duty_set(&PWM2, 0, 0));}
+        return;
     }
-    if(pin_no == BUTTON_2 && button_action == APP_BUTTON_PUSH)
+
+    m_servo_angle = (int16_t)MAX(SERVO_CAL_ANGLE_MIN_DDEG, MIN(SERVO_CAL_ANGLE_MAX_DDEG, angle_ddeg));
+
+    // The calibration is made for the default period, "mode" may have shortened it.
+    APP_ERROR_CHECK(servo_cal_pulse_get(0, m_servo_angle, &pulse_us));
+    APP_ERROR_CHECK(servo_motion_move(0, MIN(pulse_us, servo_period_get())));
+    latency_arm(LATENCY_PATH_SERVO);
+}
+
+/** @brief Function for running a button gesture in the main loop.
+ *
+ * @details Button 1 turns the servo up and button 2 down: a click moves to
+ *          the preset angle, a double click to the end, and holding the button
+ *          jogs. Both buttons together center the servo.
+ */
+static void button_action(void const * p_data, uint16_t size)
+{
+    button_gesture_evt_t const * p_evt = p_data;
+
+    UNUSED_PARAMETER(size);
+
+    int32_t direction = (p_evt->pins == BUTTON_SCAN_MASK(BUTTON_1)) ? 1 : -1;
+    uint8_t button    = (direction > 0) ? 1 : 2;
+
+    switch (p_evt->type)
     {
-        NRF_LOG_INFO("Button 2 pressed \r\n");
-        nrf_drv_gpiote_out_task_trigger(LED_2);
-        APP_ERROR_CHECK(app_pwm_channel_duty_set(&PWM2, 0, 5));
-        ready_flag = false;
-        nrf_delay_ms(1000);
-        while(!ready_flag){APP_ERROR_CHECK(app_pwm_channel_duty_set(&PWM2, 0, 0));}
+        case BUTTON_GESTURE_CLICK:
+            TLOG("Button %d click", button);
+            led_button_show(button);
+            servo_button_move((button == 1) ? SERVO_ANGLE_BUTTON_1_DDEG : SERVO_ANGLE_BUTTON_2_DDEG);
+            break;
+
+        case BUTTON_GESTURE_DOUBLE_CLICK:
+            TLOG("Button %d double click", button);
+            led_button_show(button);
+            servo_button_move((button == 1) ? SERVO_CAL_ANGLE_MAX_DDEG : SERVO_CAL_ANGLE_MIN_DDEG);
+            break;
+
+        case BUTTON_GESTURE_LONG_PRESS:
+            TLOG("Button %d long press", button);
+            led_button_show(button);
+            servo_button_move(m_servo_angle + direction * SERVO_ANGLE_JOG_DDEG);
+            break;
+
+        case BUTTON_GESTURE_REPEAT:
+            servo_button_move(m_servo_angle + direction * SERVO_ANGLE_JOG_DDEG);
+            break;
+
+        case BUTTON_GESTURE_CHORD:
+            TLOG("Button chord");
+            led_button_show(0);
+            servo_button_move((SERVO_CAL_ANGLE_MIN_DDEG + SERVO_CAL_ANGLE_MAX_DDEG) / 2);
+            break;
+
+        default:
+            break;
     }
+}
+
 
+/** @brief Function for handling button gestures. Only queues them, the actions run in the main loop. */
+static void button_handler(button_gesture_evt_t const * p_evt)
+{
+    // A full queue drops the gesture, which is counted in the statistics.
+    (void)defer_put(button_action, p_evt, sizeof(*p_evt));
 }
 
 
 static void buttons_init()
 {
     ret_code_t err_code;
-/*
-    static app_button_cfg_t button_cfg = {
-      .pin_no = BUTTON_1,
-      .active_state = APP_BUTTON_ACTIVE_LOW,
-      .pull_cfg = NRF_GPIO_PIN_PULLUP,
-      .button_handler = button_handler 
-    };
-*/
-    static app_button_cfg_t button_cfg[2] = {
-        {BUTTON_1,APP_BUTTON_ACTIVE_LOW,NRF_GPIO_PIN_PULLUP,button_handler},
-        {BUTTON_2,APP_BUTTON_ACTIVE_LOW,NRF_GPIO_PIN_PULLUP,button_handler}
-    };
 
-    err_code = app_button_init(button_cfg,2,5);
-    APP_ERROR_CHECK(err_code);
+    static uint8_t const button_pins[] = { BUTTON_1, BUTTON_2 };
 
-    err_code = app_button_enable();
+    err_code = defer_init();
     APP_ERROR_CHECK(err_code);
-}
 
-void pwm_ready_callback(uint32_t pwm_id)    // PWM callback function
-{
-    ready_flag = true;
+    // The buttons pull their pins low, see BUTTON_PULL.
+    err_code = button_gesture_init(button_pins, ARRAY_SIZE(button_pins), true, button_handler);
+    APP_ERROR_CHECK(err_code);
 }
 
 static void pwm_init()
 {
     ret_code_t err_code;
-    
-    app_pwm_config_t pwm2_cfg = APP_PWM_DEFAULT_CONFIG_1CH(20000L, 4);
-    pwm2_cfg.pin_polarity[0] = APP_PWM_POLARITY_ACTIVE_HIGH;
 
-    err_code = app_pwm_init(&PWM2,&pwm2_cfg,pwm_ready_callback);
+    // The servo runs on the PWM peripheral, TIMER2 debounces the buttons.
+    // Channels without a pin in the list are not connected.
+    static const uint8_t servo_pins[] = { SERVO_PIN };
+
+    err_code = servo_init(servo_pins, ARRAY_SIZE(servo_pins));
+    APP_ERROR_CHECK(err_code);
+
+    // Button moves are planned and advanced from an application timer, the handler never waits.
+    err_code = servo_motion_init();
     APP_ERROR_CHECK(err_code);
 
-    app_pwm_enable(&PWM2);
+    // The encoder is counted from now on, closed-loop control starts with the "ctrl" command.
+    static const servo_ctrl_config_t ctrl_config = SERVO_CTRL_DEFAULT_CONFIG;
+
+    err_code = servo_ctrl_init(&ctrl_config);
+    APP_ERROR_CHECK(err_code);
 }
 
 void clock_event_handler(nrf_drv_clock_evt_type_t event)
 {
   if(event == NRF_DRV_CLOCK_EVT_LFCLK_STARTED )
   {
-     NRF_LOG_INFO("LFCLK started \r\n");
+     TLOG("LFCLK started");
   }
 
 }
@@ -333,34 +422,355 @@ static void lfclk_init()
 
 }
 
-void uart_event_handler(app_uart_evt_t * p_event)
+/** @brief Command "pwm <channel> <duty %>": sets the duty cycle of a servo channel. */
+static ret_code_t cmd_pwm(size_t argc, char * const * argv)
+{
+    uint32_t channel;
+    uint32_t duty;
+
+    if ((argc != 2) ||
+        (uart_cmd_arg_u32(argv[0], &channel) != NRF_SUCCESS) ||
+        (uart_cmd_arg_u32(argv[1], &duty) != NRF_SUCCESS) ||
+        (channel >= SERVO_CHANNEL_COUNT) || (duty > 100))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // A direct duty overrides any move in progress.
+    servo_motion_stop((uint8_t)channel);
+
+    return servo_pulse_set((uint8_t)channel, (uint16_t)((duty * servo_period_get()) / 100));
+}
+
+/** @brief Command "pose <us> [<us> ...]": sets the pulses of servo channels 0 and up in the same period. */
+static ret_code_t cmd_pose(size_t argc, char * const * argv)
+{
+    uint16_t pulses[SERVO_CHANNEL_COUNT];
+    uint16_t period_us = servo_period_get();
+
+    if ((argc == 0) || (argc > SERVO_CHANNEL_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        uint32_t pulse = servo_pulse_get(i);
+
+        if ((i < argc) &&
+            ((uart_cmd_arg_u32(argv[i], &pulse) != NRF_SUCCESS) || (pulse > period_us)))
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+        pulses[i] = (uint16_t)pulse;
+    }
+
+    for (uint32_t i = 0; i < argc; i++)
+    {
+        servo_motion_stop(i);
+    }
+
+    return servo_pose_set(pulses);
+}
+
+/** @brief Command "mode <period us> <active low 0|1> <channels>": changes the servo output mode at the next period boundary. */
+static ret_code_t cmd_mode(size_t argc, char * const * argv)
+{
+    uint32_t period_us;
+    uint32_t active_low;
+    uint32_t channels;
+
+    if ((argc != 3) ||
+        (uart_cmd_arg_u32(argv[0], &period_us) != NRF_SUCCESS) ||
+        (uart_cmd_arg_u32(argv[1], &active_low) != NRF_SUCCESS) ||
+        (uart_cmd_arg_u32(argv[2], &channels) != NRF_SUCCESS) ||
+        (period_us > UINT16_MAX) || (active_low > 1) || (channels > SERVO_CHANNEL_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    servo_mode_t const mode =
+    {
+        .period_us     = (uint16_t)period_us,
+        .active_low    = (active_low != 0),
+        .channel_count = (uint8_t)channels
+    };
+
+    // Pulses of the old period may not fit the new one, so nothing keeps moving.
+    servo_ctrl_stop();
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        servo_motion_stop(i);
+    }
+
+    return servo_mode_set(&mode, NULL);
+}
+
+/** @brief Command "angle <channel> <0.1 degree>": moves a servo channel to an angle. */
+static ret_code_t cmd_angle(size_t argc, char * const * argv)
+{
+    ret_code_t err_code;
+    uint32_t   channel;
+    int32_t    angle;
+    uint16_t   pulse_us;
+
+    if ((argc != 2) ||
+        (uart_cmd_arg_u32(argv[0], &channel) != NRF_SUCCESS) ||
+        (uart_cmd_arg_i32(argv[1], &angle) != NRF_SUCCESS) ||
+        (channel >= SERVO_CHANNEL_COUNT) || (angle < INT16_MIN) || (angle > INT16_MAX))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    err_code = servo_cal_pulse_get((uint8_t)channel, (int16_t)angle, &pulse_us);
+    VERIFY_SUCCESS(err_code);
+
+    return servo_motion_move((uint8_t)channel, pulse_us);
+}
+
+/** @brief Command "trim <channel> <us>": sets the trim of a servo channel, used by later angle moves. */
+static ret_code_t cmd_trim(size_t argc, char * const * argv)
+{
+    uint32_t channel;
+    int32_t  trim;
+
+    if ((argc != 2) ||
+        (uart_cmd_arg_u32(argv[0], &channel) != NRF_SUCCESS) ||
+        (uart_cmd_arg_i32(argv[1], &trim) != NRF_SUCCESS) ||
+        (channel >= SERVO_CHANNEL_COUNT) || (trim < INT16_MIN) || (trim > INT16_MAX))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    return servo_cal_trim_set((uint8_t)channel, (int16_t)trim);
+}
+
+/** @brief Command "ctrl [<target counts>]": runs closed-loop control of servo channel 0 to a target, or stops it without argument. */
+static ret_code_t cmd_ctrl(size_t argc, char * const * argv)
+{
+    int32_t target;
+
+    if (argc == 0)
+    {
+        servo_ctrl_stop();
+        return NRF_SUCCESS;
+    }
+    if ((argc != 1) || (uart_cmd_arg_i32(argv[0], &target) != NRF_SUCCESS))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    servo_ctrl_target_set(target);
+
+    return servo_ctrl_start();
+}
+
+/** @brief Command "ctrlstat": logs and clears the closed-loop timing statistics. */
+static ret_code_t cmd_ctrlstat(size_t argc, char * const * argv)
+{
+    servo_ctrl_stats_t stats;
+
+    if (argc != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    servo_ctrl_stats_get(&stats);
+
+    TLOG("ctrl loops %u reports %u overflows %u double %u error %d",
+         stats.loops, stats.reports, stats.overflows, stats.double_trans, stats.error);
+    TLOG("ctrl exec %u/%u/%u cycles, interval %u-%u us",
+         stats.exec_min_cycles, stats.exec_avg_cycles, stats.exec_max_cycles,
+         stats.interval_min_us, stats.interval_max_us);
+
+    return NRF_SUCCESS;
+}
+
+/** @brief Command "sched": logs and clears the statistics of the deferred button actions. */
+static ret_code_t cmd_sched(size_t argc, char * const * argv)
+{
+    defer_stats_t stats;
+
+    if (argc != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    defer_stats_get(&stats);
+
+    TLOG("sched posted %u dropped %u depth %u latency %u/%u us",
+         stats.posted, stats.dropped, stats.max_depth, stats.avg_latency_us, stats.max_latency_us);
+
+    return NRF_SUCCESS;
+}
+
+/** @brief Command "latency": logs and clears the button to output latency of every path. */
+static ret_code_t cmd_latency(size_t argc, char * const * argv)
+{
+    if (argc != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    for (uint32_t path = 0; path < LATENCY_PATH_COUNT; path++)
+    {
+        latency_stats_t stats;
+
+        latency_stats_get((latency_path_t)path, &stats);
+
+        TLOG("latency %u count %u min %u avg %u max %u us",
+             path, stats.count, stats.min_us, stats.avg_us, stats.max_us);
+        STATIC_ASSERT(LATENCY_HIST_BINS == 10);
+        TLOG("latency %u hist %u %u %u %u %u",
+             path, stats.hist[0], stats.hist[1], stats.hist[2], stats.hist[3], stats.hist[4]);
+        TLOG("latency %u hist %u %u %u %u %u",
+             path, stats.hist[5], stats.hist[6], stats.hist[7], stats.hist[8], stats.hist[9]);
+    }
+
+    return NRF_SUCCESS;
+}
+
+/** @brief Command "timer <period ms>": changes the on and off time of the LED_1 blink, 1 to 60000 ms. */
+static ret_code_t cmd_timer(size_t argc, char * const * argv)
+{
+    ret_code_t err_code;
+    uint32_t   period_ms;
+
+    if ((argc != 1) ||
+        (uart_cmd_arg_u32(argv[0], &period_ms) != NRF_SUCCESS) ||
+        (period_ms == 0) || (period_ms > 60000))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Fails if this interrupts led_button_show(), which reads the same steps.
+    err_code = led_pwm_claim();
+    VERIFY_SUCCESS(err_code);
+    m_led_blink[0].duration_ms = (uint16_t)period_ms;
+    m_led_blink[1].duration_ms = (uint16_t)period_ms;
+    m_led_on[0].duration_ms    = (uint16_t)period_ms;
+    led_pwm_release();
+
+    return led_pwm_play(m_led_patterns, 0);
+}
+
+/** @brief Command "dim <percent>": holds all LEDs at one brightness, 0 to 100 %, and checks that
+ *         it is dithered. "timer" or a button press restores the blink. */
+static ret_code_t cmd_dim(size_t argc, char * const * argv)
 {
-    static uint8_t data_array[32];
-    static uint8_t index = 0;
+    ret_code_t     err_code;
+    uint32_t       level;
+    led_pwm_info_t info;
+
+    if ((argc != 1) ||
+        (uart_cmd_arg_u32(argv[0], &level) != NRF_SUCCESS) ||
+        (level > 100))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
 
-    switch (p_event->evt_type)
+    // Steps are compiled by led_pwm_play(), they can live on the stack.
+    led_pwm_step_t const    hold[]                      = { LED_PWM_HOLD((uint8_t)level, 1000) };
+    led_pwm_pattern_t const patterns[LED_PWM_LED_COUNT] =
     {
-        case APP_UART_DATA_READY:
-            app_uart_get(&data_array[index]);
-            index++;
-
-            if (data_array[index - 1] == '\n') 
-            {
-                for (uint32_t i = 0; i < strlen((const char *)data_array); i++)
-                {
-                    while (app_uart_put(data_array[i]) != NRF_SUCCESS);
-                }
-                memset(data_array,0,sizeof(data_array));
-                index = 0;
-            }
+        { hold, ARRAY_SIZE(hold) },
+        { hold, ARRAY_SIZE(hold) },
+        { hold, ARRAY_SIZE(hold) },
+        { hold, ARRAY_SIZE(hold) },
+    };
+
+    err_code = led_pwm_play(patterns, 0);
+    VERIFY_SUCCESS(err_code);
+
+    led_pwm_info_get(&info);
+    TLOG("led dither %u entries %u refresh %u", info.dither_periods, info.entries, info.refresh);
+
+    // A dithered level must change every PWM period.
+    if (((info.dither_periods == 1) && (LED_PWM_DITHER_PERIODS > 1)) || (info.refresh != 0))
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+
+    return NRF_SUCCESS;
+}
+
+/** @brief Command "gpio <pin> <0|1>": configures a pin as output and writes it. */
+static ret_code_t cmd_gpio(size_t argc, char * const * argv)
+{
+    uint32_t pin;
+    uint32_t value;
+
+    if ((argc != 2) ||
+        (uart_cmd_arg_u32(argv[0], &pin) != NRF_SUCCESS) ||
+        (uart_cmd_arg_u32(argv[1], &value) != NRF_SUCCESS) ||
+        (pin >= NUMBER_OF_PINS) || (value > 1))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    nrf_gpio_cfg_output(pin);
+    nrf_gpio_pin_write(pin, value);
+
+    return NRF_SUCCESS;
+}
+
+// Commands accepted over the UART, see uart_cmd.h.
+static const uart_cmd_t m_commands[] =
+{
+    { "pwm",      cmd_pwm      },
+    { "pose",     cmd_pose     },
+    { "mode",     cmd_mode     },
+    { "angle",    cmd_angle    },
+    { "trim",     cmd_trim     },
+    { "ctrl",     cmd_ctrl     },
+    { "ctrlstat", cmd_ctrlstat },
+    { "sched",    cmd_sched    },
+    { "latency",  cmd_latency  },
+    { "timer",    cmd_timer    },
+    { "dim",      cmd_dim      },
+    { "gpio",     cmd_gpio     },
+};
+
+STATIC_ASSERT(ARRAY_SIZE(m_commands) <= UART_CMD_MAX_COUNT);
+
+/** @brief Function for handling a valid frame received on the UART. Frames not used by a module are echoed back. */
+static void uart_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length)
+{
+    if (uart_baud_frame_handler(type, p_payload, length) ||
+        uart_cmd_frame_handler(type, p_payload, length))
+    {
+        return;
+    }
+#ifdef UART_BENCH
+    if (uart_bench_frame_handler(type, p_payload, length))
+    {
+        return;
+    }
+#endif
+    // By reference, the frame is sent straight from the RX buffer.
+    (void)uart_frame_forward();
+}
+
+void uart_event_handler(uart_dma_evt_t const * p_event)
+{
+    switch (p_event->type)
+    {
+        case UART_DMA_EVT_RX_DATA:
+#ifdef UART_BENCH
+            uart_bench_rx_data(p_event->data.rxtx.length);
+#endif
+            // Decode the whole chunk in one go, frames may span several chunks.
+            uart_frame_input(p_event->data.rxtx.p_data, p_event->data.rxtx.length);
             break;
 
-        case APP_UART_COMMUNICATION_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_communication);
+#ifdef UART_BENCH
+        case UART_DMA_EVT_TX_DONE:
+            uart_bench_tx_done(p_event->data.rxtx.length);
             break;
+#endif
 
-        case APP_UART_FIFO_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_code);
+        case UART_DMA_EVT_ERROR:
+            APP_ERROR_HANDLER(p_event->data.error_mask);
             break;
 
         default:
@@ -370,42 +780,48 @@ void uart_event_handler(app_uart_evt_t * p_event)
 
 static void uart_init()
 {
-
     uint32_t err_code;
-    const app_uart_comm_params_t uart_comm_params =
+    const uart_dma_config_t uart_config =
     {
-        RX_PIN_NUMBER,
-        TX_PIN_NUMBER,
-        RTS_PIN_NUMBER,
-        CTS_PIN_NUMBER,
-        APP_UART_FLOW_CONTROL_DISABLED,
-        false,
-        UART_BAUDRATE_BAUDRATE_Baud115200
+        .rx_pin       = RX_PIN_NUMBER,
+        .tx_pin       = TX_PIN_NUMBER,
+        .rts_pin      = RTS_PIN_NUMBER,
+        .cts_pin      = CTS_PIN_NUMBER,
+        .hwfc         = NRF_UART_HWFC_DISABLED,
+        .baudrate     = NRF_UART_BAUDRATE_115200,
+        .irq_priority = APP_IRQ_PRIORITY_LOWEST,
+        .tx_overflow  = UART_DMA_TX_OVERFLOW_DROP_OLDEST,
     };
 
-    APP_UART_FIFO_INIT( &uart_comm_params,
-                       UART_RX_BUF_SIZE,
-                       UART_TX_BUF_SIZE,
-                       uart_event_handler,
-                       APP_IRQ_PRIORITY_LOWEST,
-                       err_code);
+    err_code = uart_frame_init(uart_frame_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = uart_cmd_init(m_commands, ARRAY_SIZE(m_commands));
     APP_ERROR_CHECK(err_code);
 
+    err_code = uart_dma_init(&uart_config, uart_event_handler);
+    APP_ERROR_CHECK(err_code);
+
+    // The host may switch to a higher rate, see uart_baud.h.
+    err_code = uart_baud_init(uart_config.baudrate, uart_config.hwfc);
+    APP_ERROR_CHECK(err_code);
 }
 
-static void uart_print(uint8_t data_string[])
+/** @brief Function for sending a message prefixed with the board id.
+ *
+ * @details The id and the message are copied straight into the UART TX queue as one write and the function
+ *          returns immediately. If the queue is full the oldest queued data is discarded, see
+ *          @ref uart_dma_tx_stats_get for the drop counters.
+ */
+static void uart_write(char const * p_data, size_t length)
 {
-  static uint8_t id[] = "[nRF52 DK]: ";
-  static uint8_t array[256];
-  
-  memcpy(array,id, sizeof(id));
-  memcpy(array+sizeof(id)-1,data_string,strlen(data_string));
-  
-  for (uint32_t i = 0; i < strlen(array); i++)
-  {
-      while (app_uart_put(array[i]) != NRF_SUCCESS);
-  }
-  
+    uart_dma_tx_seg_t const segs[] =
+    {
+        { .p_data = UART_ID_PREFIX, .length = sizeof(UART_ID_PREFIX) - 1 },
+        { .p_data = p_data,         .length = length                     },
+    };
+
+    (void)uart_dma_tx_gather(segs, ARRAY_SIZE(segs));
 }
 
 static void power_manage()
@@ -440,7 +856,7 @@ int main(void)
 
     lfclk_init();
     
-    // Must be called before buttons_init as the Button Handler library(app_button.c) is used.
+    // Must be called before the modules that use application timers.
     application_timer_init();
     
     // Initialize the buttons
@@ -451,19 +867,27 @@ int main(void)
     //ppi_init();
     //timer_init();
 
+    // Uses TIMER0, which timer_init() above would need.
+    APP_ERROR_CHECK(latency_init());
+
     pwm_init();
+
+    leds_init();
     
     uart_init();
 
-    uart_print("Nordic Semiconductor ASA\r\n");
+#ifdef UART_BENCH
+    // The TX test exercises uart_write.
+    APP_ERROR_CHECK(uart_bench_init(uart_write));
+#endif
 
-    nrf_gpio_cfg_output(LED_1);
+    UART_PRINT("Nordic Semiconductor ASA\r\n");
 
     while (true)
     {
-        
-        //power_manage();
-        // Do nothing.
+        uart_baud_process();
+        defer_execute();
+        power_manage();
         //nrf_delay_ms(1000);
         //nrf_gpio_pin_toggle(LED_1);
     }
@@ -0,0 +1,698 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+
+#include "servo.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_gpio.h"
+#include "app_timer.h"
+#include "latency.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+
+// Output high from the start of the period until the compare value, so the
+// compare value is the pulse width. Without it the pulse is low.
+#define SERVO_POLARITY_HIGH     0x8000
+
+#define SERVO_PPI_COUNT         ((SERVO_INSTANCE_COUNT + 1) / 2)    // One task and one fork per channel.
+
+// Sequence end interrupts of PWM0, used to find the period boundary.
+#define SERVO_SEQEND_INT_MASK   (NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK)
+
+static nrf_drv_pwm_t const m_pwm[SERVO_INSTANCE_COUNT] =
+{
+    NRF_DRV_PWM_INSTANCE(0),
+#if SERVO_INSTANCE_COUNT > 1
+    NRF_DRV_PWM_INSTANCE(1),
+#endif
+#if SERVO_INSTANCE_COUNT > 2
+    NRF_DRV_PWM_INSTANCE(2),
+#endif
+};
+
+static nrf_pwm_values_individual_t  m_values[2][SERVO_INSTANCE_COUNT];  // Double buffer, one period of every instance.
+static uint8_t                      m_active;                           // Index of the buffer being played.
+static volatile bool                m_swap_pending;
+static volatile uint16_t            m_pulse[SERVO_CHANNEL_COUNT];       // Mailbox, latest pulse of each channel.
+static uint8_t                      m_pins[SERVO_CHANNEL_COUNT];
+static servo_mode_t                 m_mode;                             // Mode being played.
+static servo_mode_t                 m_next_mode;
+static volatile bool                m_mode_pending;                     // A mode change waits for the next boundary.
+static bool                         m_stopping;                         // The instances stop at the next boundary.
+static bool                         m_idle_pending;                     // Output constant for the idle timeout, stop at the next boundary.
+static bool                         m_idle_timing;                      // The idle timer is running.
+static volatile bool                m_idle;                             // Instances stopped and disabled, pins held by the GPIO.
+static servo_stats_t                m_stats;
+static nrf_ppi_channel_t            m_ppi_start[SERVO_PPI_COUNT];
+static bool                         m_initialized;
+
+APP_TIMER_DEF(m_idle_timer_id);
+
+
+static void values_write(nrf_pwm_values_individual_t * p_values)
+{
+    uint16_t polarity = m_mode.active_low ? 0 : SERVO_POLARITY_HIGH;
+
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        uint16_t * p_value = &p_values[i].channel_0;
+
+        for (uint32_t j = 0; j < NRF_PWM_CHANNEL_COUNT; j++)
+        {
+            uint32_t channel = i * NRF_PWM_CHANNEL_COUNT + j;
+            uint16_t pulse   = (channel < m_mode.channel_count) ? m_pulse[channel] : 0;
+
+            p_value[j] = MIN(pulse, m_mode.period_us) | polarity;
+        }
+    }
+}
+
+
+// True if no driven channel toggles: every pulse is either 0 or the full period.
+static bool output_constant(void)
+{
+    for (uint32_t i = 0; i < m_mode.channel_count; i++)
+    {
+        if ((m_pulse[i] != 0) && (m_pulse[i] < m_mode.period_us))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+// Connects the channels of the mode and sets the level of the pins while
+// they are not driven. Only called while the instances are stopped.
+static void outputs_configure(void)
+{
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        uint32_t pins[NRF_PWM_CHANNEL_COUNT];
+
+        for (uint32_t j = 0; j < NRF_PWM_CHANNEL_COUNT; j++)
+        {
+            uint32_t channel = i * NRF_PWM_CHANNEL_COUNT + j;
+            uint8_t  pin     = m_pins[channel];
+
+            pins[j] = NRF_PWM_PIN_NOT_CONNECTED;
+            if (pin != SERVO_PIN_NOT_USED)
+            {
+                nrf_gpio_pin_write(pin, m_mode.active_low ? 1 : 0);
+                if (channel < m_mode.channel_count)
+                {
+                    pins[j] = pin;
+                }
+            }
+        }
+
+        nrf_pwm_disable(m_pwm[i].p_registers);
+        nrf_pwm_pins_set(m_pwm[i].p_registers, pins);
+        nrf_pwm_configure(m_pwm[i].p_registers, NRF_PWM_CLK_1MHz, NRF_PWM_MODE_UP, m_mode.period_us);
+        nrf_pwm_enable(m_pwm[i].p_registers);
+    }
+}
+
+
+// Disables the stopped instances and holds each pin at the constant level
+// of its channel. The PWM no longer requests the high frequency clock.
+static void outputs_park(void)
+{
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        if (m_pins[i] != SERVO_PIN_NOT_USED)
+        {
+            bool active = (i < m_mode.channel_count) && (m_pulse[i] != 0);
+
+            nrf_gpio_pin_write(m_pins[i], (active != m_mode.active_low) ? 1 : 0);
+        }
+    }
+
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        nrf_pwm_disable(m_pwm[i].p_registers);
+    }
+}
+
+
+// Arms the looped playback of the active buffer and returns the start task.
+static uint32_t playback_arm(uint32_t instance)
+{
+    nrf_pwm_sequence_t const seq =
+    {
+        .values.p_individual = &m_values[m_active][instance],
+        .length              = NRF_PWM_VALUES_LENGTH(m_values[0][0]),
+        .repeats             = 0,
+        .end_delay           = 0
+    };
+
+    // Both sequence slots play the same single-period sequence, looped
+    // forever. Only PWM0 reports the period boundary.
+    return nrf_drv_pwm_simple_playback(&m_pwm[instance], &seq, 1,
+                                       NRF_DRV_PWM_FLAG_LOOP |
+                                       NRF_DRV_PWM_FLAG_START_VIA_TASK |
+                                       ((instance == 0) ? (NRF_DRV_PWM_FLAG_SIGNAL_END_SEQ0 |
+                                                           NRF_DRV_PWM_FLAG_SIGNAL_END_SEQ1 |
+                                                           NRF_DRV_PWM_FLAG_NO_EVT_FINISHED) : 0));
+}
+
+
+// Starts all armed instances in the same clock cycle.
+static void playback_start(void)
+{
+    SERVO_START_EGU->EVENTS_TRIGGERED[0] = 0;
+    SERVO_START_EGU->TASKS_TRIGGER[0]    = 1;
+}
+
+
+// Reconfigures the stopped instances for the current mode and the active
+// buffer, and starts them together. The first period starts at the counter
+// reset, so its pulse is complete and aligned on all channels.
+static void playback_restart(void)
+{
+    outputs_configure();
+
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        (void)playback_arm(i);
+    }
+
+    // Updates made since the values were written still need their swap.
+    CRITICAL_REGION_ENTER();
+    if (!m_swap_pending)
+    {
+        nrf_pwm_int_disable(m_pwm[0].p_registers, SERVO_SEQEND_INT_MASK);
+    }
+    CRITICAL_REGION_EXIT();
+
+    playback_start();
+}
+
+
+// Must be called inside a critical region.
+static void boundary_request(void)
+{
+    // Drop old events so the interrupt comes at the next boundary.
+    nrf_pwm_event_clear(m_pwm[0].p_registers, NRF_PWM_EVENT_SEQEND0);
+    nrf_pwm_event_clear(m_pwm[0].p_registers, NRF_PWM_EVENT_SEQEND1);
+    nrf_pwm_int_enable(m_pwm[0].p_registers, SERVO_SEQEND_INT_MASK);
+}
+
+
+// Must be called inside a critical region while idle, after the mailbox or
+// the mode has changed. Restarts playback as soon as the output toggles.
+static void idle_update(void)
+{
+    values_write(m_values[m_active]);
+    if (output_constant())
+    {
+        outputs_park();
+    }
+    else
+    {
+        m_idle = false;
+        m_stats.wakeups++;
+        playback_restart();
+        latency_output(LATENCY_PATH_SERVO, latency_now());
+    }
+}
+
+
+// (Re)starts the idle timeout while the output is constant, stops it otherwise.
+static void idle_check(void)
+{
+    if (output_constant())
+    {
+        (void)app_timer_stop(m_idle_timer_id);
+        (void)app_timer_start(m_idle_timer_id, APP_TIMER_TICKS(SERVO_IDLE_TIMEOUT_MS), NULL);
+        m_idle_timing = true;
+    }
+    else if (m_idle_timing)
+    {
+        (void)app_timer_stop(m_idle_timer_id);
+        m_idle_timing = false;
+    }
+}
+
+
+static void buffers_swap(void)
+{
+    // A producer of higher priority must not change the mailbox half way.
+    CRITICAL_REGION_ENTER();
+    values_write(m_values[m_active ^ 1]);
+    m_swap_pending = false;
+    nrf_pwm_int_disable(m_pwm[0].p_registers, SERVO_SEQEND_INT_MASK);
+    CRITICAL_REGION_EXIT();
+
+    m_active ^= 1;
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        nrf_pwm_values_t values = { .p_individual = &m_values[m_active][i] };
+
+        nrf_drv_pwm_sequence_values_update(&m_pwm[i], 0, values);
+        nrf_drv_pwm_sequence_values_update(&m_pwm[i], 1, values);
+    }
+
+    m_stats.swaps++;
+
+    // The new pulses start at the boundary that ends the current period.
+    latency_output(LATENCY_PATH_SERVO, latency_boundary_get() + m_mode.period_us);
+
+    idle_check();
+}
+
+
+// All instances have stopped at the same boundary. Restart them in the new mode.
+static void mode_apply(void)
+{
+    for (uint32_t i = 1; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        (void)nrf_drv_pwm_stop(&m_pwm[i], true);
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_mode = m_next_mode;
+    values_write(m_values[m_active]);
+    m_mode_pending = false;
+    m_idle_pending = false;
+    m_stopping     = false;
+    m_swap_pending = false;
+    CRITICAL_REGION_EXIT();
+
+    playback_restart();
+
+    m_stats.mode_changes++;
+
+    idle_check();
+}
+
+
+// All instances have stopped at the same boundary because the output was
+// constant. An update that came in the meantime restarts them right away.
+static void idle_enter(void)
+{
+    bool constant;
+
+    for (uint32_t i = 1; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        (void)nrf_drv_pwm_stop(&m_pwm[i], true);
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_idle_pending = false;
+    m_stopping     = false;
+    m_swap_pending = false;
+    values_write(m_values[m_active]);
+    constant = output_constant();
+    if (constant)
+    {
+        outputs_park();
+        m_idle = true;
+        m_stats.idle_entries++;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (!constant)
+    {
+        playback_restart();
+        idle_check();
+    }
+}
+
+
+static void idle_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    m_idle_timing = false;
+
+    // Stop at the next boundary, unless an update or a mode change is on its way.
+    CRITICAL_REGION_ENTER();
+    if (!m_idle && !m_mode_pending && !m_swap_pending && output_constant())
+    {
+        m_idle_pending = true;
+        boundary_request();
+    }
+    CRITICAL_REGION_EXIT();
+}
+
+
+// SEQEND comes right after a period boundary. The idle buffer is filled from
+// the mailbox and the instances read the new pointers at the next boundary,
+// so the swap reaches all of them in the same period. A mode change instead
+// stops all instances at the next boundary, and STOPPED restarts them.
+static void pwm_handler(nrf_drv_pwm_evt_type_t event_type)
+{
+    switch (event_type)
+    {
+        case NRF_DRV_PWM_EVT_END_SEQ0:
+        case NRF_DRV_PWM_EVT_END_SEQ1:
+            if (m_mode_pending)
+            {
+                if (!m_stopping)
+                {
+                    m_stopping = true;
+                    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+                    {
+                        (void)nrf_drv_pwm_stop(&m_pwm[i], false);
+                    }
+                }
+            }
+            else if (m_swap_pending)
+            {
+                // The update cancels a pending stop, the swap restarts the idle timeout.
+                m_idle_pending = false;
+                buffers_swap();
+            }
+            else if (m_idle_pending && !m_stopping)
+            {
+                m_stopping = true;
+                for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+                {
+                    (void)nrf_drv_pwm_stop(&m_pwm[i], false);
+                }
+            }
+            break;
+
+        case NRF_DRV_PWM_EVT_STOPPED:
+            if (m_stopping)
+            {
+                if (m_mode_pending)
+                {
+                    mode_apply();
+                }
+                else
+                {
+                    idle_enter();
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+// Must be called inside a critical region, after the mailbox has been written.
+static void swap_request(void)
+{
+    m_stats.updates++;
+
+    if (m_idle)
+    {
+        idle_update();
+    }
+    else if (!m_swap_pending)
+    {
+        m_swap_pending = true;
+        if (!m_mode_pending)
+        {
+            boundary_request();
+        }
+    }
+}
+
+
+static ret_code_t start_ppi_init(uint32_t const * p_start_tasks)
+{
+    ret_code_t err_code;
+
+    err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return err_code;
+    }
+
+    // Every channel starts one instance and forks to the next.
+    for (uint32_t i = 0; i < SERVO_PPI_COUNT; i++)
+    {
+        uint32_t first = 2 * i;
+
+        err_code = nrf_drv_ppi_channel_alloc(&m_ppi_start[i]);
+        VERIFY_SUCCESS(err_code);
+        err_code = nrf_drv_ppi_channel_assign(m_ppi_start[i],
+                                              (uint32_t)&SERVO_START_EGU->EVENTS_TRIGGERED[0],
+                                              p_start_tasks[first]);
+        VERIFY_SUCCESS(err_code);
+        if (first + 1 < SERVO_INSTANCE_COUNT)
+        {
+            err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_start[i], p_start_tasks[first + 1]);
+            VERIFY_SUCCESS(err_code);
+        }
+        err_code = nrf_drv_ppi_channel_enable(m_ppi_start[i]);
+        VERIFY_SUCCESS(err_code);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_init(uint8_t const * p_pins, uint8_t count)
+{
+    ret_code_t         err_code;
+    uint32_t           start_tasks[SERVO_INSTANCE_COUNT];
+    servo_mode_t const mode = SERVO_DEFAULT_MODE;
+
+    VERIFY_PARAM_NOT_NULL(p_pins);
+    if (count > SERVO_CHANNEL_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_mode          = mode;
+    m_active        = 0;
+    m_swap_pending  = false;
+    m_mode_pending  = false;
+    m_stopping      = false;
+    m_idle_pending  = false;
+    m_idle_timing   = false;
+    m_idle          = false;
+    m_stats.updates      = 0;
+    m_stats.swaps        = 0;
+    m_stats.mode_changes = 0;
+    m_stats.idle_entries = 0;
+    m_stats.wakeups      = 0;
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        m_pulse[i] = 0;
+        m_pins[i]  = (i < count) ? p_pins[i] : SERVO_PIN_NOT_USED;
+    }
+    values_write(m_values[m_active]);
+
+    for (uint32_t i = 0; i < SERVO_INSTANCE_COUNT; i++)
+    {
+        uint8_t const * p_inst_pins = &m_pins[i * NRF_PWM_CHANNEL_COUNT];
+
+        nrf_drv_pwm_config_t const config =
+        {
+            .output_pins  = { p_inst_pins[0], p_inst_pins[1], p_inst_pins[2], p_inst_pins[3] },
+            .irq_priority = APP_IRQ_PRIORITY_LOWEST,
+            .base_clock   = NRF_PWM_CLK_1MHz,
+            .count_mode   = NRF_PWM_MODE_UP,
+            .top_value    = m_mode.period_us,
+            .load_mode    = NRF_PWM_LOAD_INDIVIDUAL,
+            .step_mode    = NRF_PWM_STEP_AUTO
+        };
+
+        // Only PWM0 reports the period boundary, the others run without interrupts.
+        err_code = nrf_drv_pwm_init(&m_pwm[i], &config, (i == 0) ? pwm_handler : NULL);
+        VERIFY_SUCCESS(err_code);
+
+        start_tasks[i] = playback_arm(i);
+    }
+    nrf_pwm_int_disable(m_pwm[0].p_registers, SERVO_SEQEND_INT_MASK);
+
+    err_code = start_ppi_init(start_tasks);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = app_timer_create(&m_idle_timer_id, APP_TIMER_MODE_SINGLE_SHOT, idle_timeout_handler);
+    VERIFY_SUCCESS(err_code);
+
+    playback_start();
+
+    m_initialized = true;
+
+    // All outputs start without pulses.
+    idle_check();
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_mode_set(servo_mode_t const * p_mode, uint16_t const * p_pulses)
+{
+    VERIFY_PARAM_NOT_NULL(p_mode);
+
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((p_mode->period_us < SERVO_PERIOD_MIN_US) || (p_mode->period_us > SERVO_PERIOD_MAX_US) ||
+        (p_mode->channel_count > SERVO_CHANNEL_COUNT))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    for (uint32_t i = 0; (p_pulses != NULL) && (i < SERVO_CHANNEL_COUNT); i++)
+    {
+        if (p_pulses[i] > p_mode->period_us)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+
+    ret_code_t err_code = NRF_SUCCESS;
+
+    CRITICAL_REGION_ENTER();
+    if (m_mode_pending)
+    {
+        err_code = NRF_ERROR_BUSY;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+        {
+            m_pulse[i] = (p_pulses != NULL) ? p_pulses[i] : 0;
+        }
+
+        // Nothing is playing while idle, so the mode applies right away.
+        if (m_idle)
+        {
+            m_mode = *p_mode;
+            m_stats.mode_changes++;
+            idle_update();
+        }
+        else
+        {
+            m_next_mode    = *p_mode;
+            m_mode_pending = true;
+            boundary_request();
+        }
+    }
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+void servo_mode_get(servo_mode_t * p_mode)
+{
+    CRITICAL_REGION_ENTER();
+    *p_mode = m_mode_pending ? m_next_mode : m_mode;
+    CRITICAL_REGION_EXIT();
+}
+
+
+uint16_t servo_period_get(void)
+{
+    uint16_t period_us;
+
+    CRITICAL_REGION_ENTER();
+    period_us = m_mode_pending ? m_next_mode.period_us : m_mode.period_us;
+    CRITICAL_REGION_EXIT();
+
+    return period_us;
+}
+
+
+ret_code_t servo_pulse_set(uint8_t channel, uint16_t pulse_us)
+{
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((channel >= SERVO_CHANNEL_COUNT) || (pulse_us > servo_period_get()))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_pulse[channel] = pulse_us;
+    swap_request();
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_pose_set(uint16_t const p_pulses[SERVO_CHANNEL_COUNT])
+{
+    uint16_t period_us = servo_period_get();
+
+    VERIFY_PARAM_NOT_NULL(p_pulses);
+
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        if (p_pulses[i] > period_us)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+
+    CRITICAL_REGION_ENTER();
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        m_pulse[i] = p_pulses[i];
+    }
+    swap_request();
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+uint16_t servo_pulse_get(uint8_t channel)
+{
+    return (channel < SERVO_CHANNEL_COUNT) ? m_pulse[channel] : 0;
+}
+
+
+void servo_stats_get(servo_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
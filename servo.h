@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup servo Servo PWM
+ * @{
+ * @brief Servo bank on the PWM peripherals with EasyDMA sequence playback.
+ *
+ * @details Each of the @ref SERVO_INSTANCE_COUNT PWM instances drives four
+ *          channels. The instances run from a 1 MHz base clock with a counter
+ *          top of the period, by default @ref SERVO_PERIOD_US, so a compare value is the pulse width
+ *          in microseconds. The channel values are played back from RAM in an
+ *          endless loop.
+ *
+ *          The instances are started by one EGU event through PPI, so they
+ *          start in the same clock cycle and their periods stay aligned.
+ *
+ *          Updates go to a mailbox that holds the latest pulse of every
+ *          channel, and never wait for the PWM. The first update after a swap
+ *          enables the sequence end interrupt of PWM0. That interrupt follows
+ *          the next period boundary: it copies the mailbox into the idle half
+ *          of a double buffer covering every instance and repoints all of
+ *          them well before the following boundary. A pose therefore takes
+ *          effect on all channels in the same period. Updates made in between
+ *          are merged and only the latest values are played. The interrupt is
+ *          disabled again until the next update.
+ *
+ *          The period, the polarity and the number of channels can be changed
+ *          at run time with @ref servo_mode_set. The change also waits for the
+ *          next boundary: the sequence end interrupt stops all instances, so
+ *          they finish the period they are in, and the stopped event
+ *          reconfigures them and starts them again through the EGU. The pins
+ *          rest at their idle level for the few microseconds in between, so
+ *          no pulse is ever cut short or merged with one of the new period.
+ *
+ *          When no driven channel has toggled for @ref SERVO_IDLE_TIMEOUT_MS,
+ *          because every pulse is 0 or the full period, the instances are
+ *          stopped at the next boundary and disabled. The pins are then held
+ *          at the same levels by the GPIO, and the PWM no longer keeps the
+ *          high frequency clock running. The first update that makes a
+ *          channel toggle restarts all instances together, so the first pulse
+ *          is complete and aligned as after @ref servo_init.
+ *
+ *          No TIMER or GPIOTE channel is used. The idle timeout takes one
+ *          app_timer.
+ */
+
+#ifndef SERVO_H__
+#define SERVO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_drv_pwm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SERVO_INSTANCE_COUNT
+#define SERVO_INSTANCE_COUNT    2                                               /**< Number of PWM instances used, starting at PWM0. PWM2 drives the LEDs, see @ref led_pwm. */
+#endif
+
+#if (SERVO_INSTANCE_COUNT < 1) || (SERVO_INSTANCE_COUNT > 3)
+#error "SERVO_INSTANCE_COUNT must be 1 to 3."
+#endif
+
+#define SERVO_PERIOD_US         20000                                           /**< Default servo frame period, 50 Hz. */
+#define SERVO_PERIOD_MIN_US     100                                             /**< Shortest period accepted by @ref servo_mode_set. */
+#define SERVO_PERIOD_MAX_US     32767                                           /**< Longest period, limited by the 15-bit counter top. */
+#define SERVO_CHANNEL_COUNT     (SERVO_INSTANCE_COUNT * NRF_PWM_CHANNEL_COUNT)  /**< Number of servo outputs. */
+#define SERVO_PIN_NOT_USED      NRF_DRV_PWM_PIN_NOT_USED                        /**< Pin value for an unused output. */
+#ifndef SERVO_IDLE_TIMEOUT_MS
+#define SERVO_IDLE_TIMEOUT_MS   100                                             /**< Time with a constant output before the instances are stopped. */
+#endif
+
+#define SERVO_START_EGU         NRF_EGU3                                        /**< EGU whose TRIGGERED[0] event starts all instances. */
+
+/**@brief Output mode of the bank. */
+typedef struct
+{
+    uint16_t period_us;         /**< Frame period in microseconds. */
+    bool     active_low;        /**< True if the pulse is low and the idle level high. */
+    uint8_t  channel_count;     /**< Number of driven channels, starting at channel 0. The pins of the others are held at the idle level. */
+} servo_mode_t;
+
+/**@brief Mode after @ref servo_init. */
+#define SERVO_DEFAULT_MODE                      \
+{                                               \
+    .period_us     = SERVO_PERIOD_US,           \
+    .active_low    = false,                     \
+    .channel_count = SERVO_CHANNEL_COUNT        \
+}
+
+/**@brief Update statistics. */
+typedef struct
+{
+    uint32_t updates;       /**< Number of accepted calls to @ref servo_pulse_set and @ref servo_pose_set. */
+    uint32_t swaps;         /**< Number of buffer swaps. Updates minus swaps were merged into a later swap. */
+    uint32_t mode_changes;  /**< Number of applied mode changes. */
+    uint32_t idle_entries;  /**< Number of times the instances were stopped on a constant output. */
+    uint32_t wakeups;       /**< Number of restarts from idle. */
+} servo_stats_t;
+
+/**@brief Function for initializing the servo outputs and starting playback.
+ *
+ * @details All outputs start without pulses, so the instances go idle after
+ *          @ref SERVO_IDLE_TIMEOUT_MS. Requires a free EGU3, one PPI channel
+ *          for every two instances and an initialized app_timer.
+ *
+ * @param[in] p_pins    Output pin of each channel, or @ref SERVO_PIN_NOT_USED.
+ * @param[in] count     Number of pins. Channels from @p count on are not used.
+ *
+ * @retval NRF_SUCCESS              Playback has started.
+ * @retval NRF_ERROR_INVALID_PARAM  More pins than channels.
+ * @return Errors from @ref nrf_drv_pwm_init and the PPI driver.
+ */
+ret_code_t servo_init(uint8_t const * p_pins, uint8_t count);
+
+/**@brief Function for setting the pulse width of a channel.
+ *
+ * @details The pulse is output from the period after the next boundary on,
+ *          together with every other change made before that boundary. Can be
+ *          called from any context and at any rate.
+ *
+ * @param[in] channel   Channel index.
+ * @param[in] pulse_us  Pulse width in microseconds, 0 for no pulse.
+ *
+ * @retval NRF_SUCCESS              The pulse has been set.
+ * @retval NRF_ERROR_INVALID_STATE  The module is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or pulse longer than the period, see @ref servo_period_get.
+ */
+ret_code_t servo_pulse_set(uint8_t channel, uint16_t pulse_us);
+
+/**@brief Function for setting the pulse widths of all channels at once.
+ *
+ * @details Same as @ref servo_pulse_set for every channel. Either all pulses
+ *          are accepted or none.
+ *
+ * @param[in] p_pulses  Pulse width of each channel in microseconds, 0 for no pulse.
+ *
+ * @retval NRF_SUCCESS              The pose has been set.
+ * @retval NRF_ERROR_INVALID_STATE  The module is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  A pulse is longer than the period.
+ */
+ret_code_t servo_pose_set(uint16_t const p_pulses[SERVO_CHANNEL_COUNT]);
+
+/**@brief Function for changing the mode at the next period boundary.
+ *
+ * @details The current period is completed in the old mode. All instances
+ *          then restart together in the new mode with the given pulses, which
+ *          replace any update not yet played.
+ *
+ * @param[in] p_mode    New mode.
+ * @param[in] p_pulses  Pulse width of each channel in microseconds, or NULL for no pulses.
+ *
+ * @retval NRF_SUCCESS              The change will be applied at the next boundary.
+ * @retval NRF_ERROR_INVALID_STATE  The module is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid mode or a pulse longer than the new period.
+ * @retval NRF_ERROR_BUSY           The previous change has not been applied yet.
+ */
+ret_code_t servo_mode_set(servo_mode_t const * p_mode, uint16_t const * p_pulses);
+
+/**@brief Function for getting the mode, including a change not yet applied.
+ *
+ * @param[out] p_mode   Mode.
+ */
+void servo_mode_get(servo_mode_t * p_mode);
+
+/**@brief Function for getting the period in microseconds that new pulses are checked against. */
+uint16_t servo_period_get(void);
+
+/**@brief Function for getting the latest pulse width of a channel in microseconds. */
+uint16_t servo_pulse_get(uint8_t channel);
+
+/**@brief Function for reading the update statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void servo_stats_get(servo_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_H__
+
+/** @} */
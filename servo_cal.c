@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+
+#include "servo_cal.h"
+#include "app_util.h"
+#include "sdk_macros.h"
+
+#define CAL_RANGE   (SERVO_CAL_ANGLE_MAX_DDEG - SERVO_CAL_ANGLE_MIN_DDEG)
+#define CAL_SPAN    (SERVO_CAL_PULSE_MAX_US - SERVO_CAL_PULSE_MIN_US)
+
+#define CAL_COUNT   (CAL_RANGE + 1)     // One entry per 0.1 degree, both ends included.
+
+// Pulse of table entry i, rounded.
+#define CAL_PULSE(i)    ((uint16_t)(SERVO_CAL_PULSE_MIN_US + ((i) * CAL_SPAN + CAL_RANGE / 2) / CAL_RANGE)),
+
+// Runs of 2^n entries from entry i.
+#define CAL_R1(i)       CAL_PULSE(i)
+#define CAL_R2(i)       CAL_R1(i) CAL_R1((i) + 1)
+#define CAL_R4(i)       CAL_R2(i) CAL_R2((i) + 2)
+#define CAL_R8(i)       CAL_R4(i) CAL_R4((i) + 4)
+#define CAL_R16(i)      CAL_R8(i) CAL_R8((i) + 8)
+#define CAL_R32(i)      CAL_R16(i) CAL_R16((i) + 16)
+#define CAL_R64(i)      CAL_R32(i) CAL_R32((i) + 32)
+#define CAL_R128(i)     CAL_R64(i) CAL_R64((i) + 64)
+#define CAL_R256(i)     CAL_R128(i) CAL_R128((i) + 128)
+#define CAL_R512(i)     CAL_R256(i) CAL_R256((i) + 256)
+#define CAL_R1024(i)    CAL_R512(i) CAL_R512((i) + 512)
+#define CAL_R2048(i)    CAL_R1024(i) CAL_R1024((i) + 1024)
+
+// Entries before the run of bit n of CAL_COUNT, the runs of the higher bits.
+#define CAL_FROM(n)     (CAL_COUNT & ~((2 << (n)) - 1))
+
+// Exactly CAL_COUNT entries, one run per bit set in CAL_COUNT.
+static const uint16_t m_table[CAL_COUNT] =
+{
+#if CAL_COUNT & 2048
+    CAL_R2048(CAL_FROM(11))
+#endif
+#if CAL_COUNT & 1024
+    CAL_R1024(CAL_FROM(10))
+#endif
+#if CAL_COUNT & 512
+    CAL_R512(CAL_FROM(9))
+#endif
+#if CAL_COUNT & 256
+    CAL_R256(CAL_FROM(8))
+#endif
+#if CAL_COUNT & 128
+    CAL_R128(CAL_FROM(7))
+#endif
+#if CAL_COUNT & 64
+    CAL_R64(CAL_FROM(6))
+#endif
+#if CAL_COUNT & 32
+    CAL_R32(CAL_FROM(5))
+#endif
+#if CAL_COUNT & 16
+    CAL_R16(CAL_FROM(4))
+#endif
+#if CAL_COUNT & 8
+    CAL_R8(CAL_FROM(3))
+#endif
+#if CAL_COUNT & 4
+    CAL_R4(CAL_FROM(2))
+#endif
+#if CAL_COUNT & 2
+    CAL_R2(CAL_FROM(1))
+#endif
+#if CAL_COUNT & 1
+    CAL_R1(CAL_FROM(0))
+#endif
+};
+
+static int16_t m_trim[SERVO_CHANNEL_COUNT];
+
+
+ret_code_t servo_cal_pulse_get(uint8_t channel, int16_t angle_ddeg, uint16_t * p_pulse_us)
+{
+    VERIFY_PARAM_NOT_NULL(p_pulse_us);
+
+    if ((channel >= SERVO_CHANNEL_COUNT) ||
+        (angle_ddeg < SERVO_CAL_ANGLE_MIN_DDEG) || (angle_ddeg > SERVO_CAL_ANGLE_MAX_DDEG))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // The range check keeps the result within SERVO_CAL_TRIM_MAX_US of the table.
+    *p_pulse_us = (uint16_t)(m_table[angle_ddeg - SERVO_CAL_ANGLE_MIN_DDEG] + m_trim[channel]);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_cal_trim_set(uint8_t channel, int16_t trim_us)
+{
+    if ((channel >= SERVO_CHANNEL_COUNT) ||
+        (trim_us < -SERVO_CAL_TRIM_MAX_US) || (trim_us > SERVO_CAL_TRIM_MAX_US))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_trim[channel] = trim_us;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_cal_angle_set(uint8_t channel, int16_t angle_ddeg)
+{
+    ret_code_t err_code;
+    uint16_t   pulse_us;
+
+    err_code = servo_cal_pulse_get(channel, angle_ddeg, &pulse_us);
+    VERIFY_SUCCESS(err_code);
+
+    return servo_pulse_set(channel, pulse_us);
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup servo_cal Servo calibration
+ * @{
+ * @brief Angle to pulse conversion with a lookup table built at compile time.
+ *
+ * @details The calibration model maps the angle range
+ *          @ref SERVO_CAL_ANGLE_MIN_DDEG to @ref SERVO_CAL_ANGLE_MAX_DDEG
+ *          linearly onto the pulse range @ref SERVO_CAL_PULSE_MIN_US to
+ *          @ref SERVO_CAL_PULSE_MAX_US. The preprocessor expands the model into
+ *          a constant table with one pulse per 0.1 degree, so a conversion is
+ *          one table read plus the trim of the channel. The resolution is only
+ *          limited by the 1 us step of the PWM.
+ *
+ *          Angles are given in tenths of a degree.
+ */
+
+#ifndef SERVO_CAL_H__
+#define SERVO_CAL_H__
+
+#include <stdint.h>
+
+#include "sdk_errors.h"
+#include "servo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef SERVO_CAL_PULSE_MIN_US
+#define SERVO_CAL_PULSE_MIN_US      500     /**< Pulse at the minimum angle. */
+#endif
+
+#ifndef SERVO_CAL_PULSE_MAX_US
+#define SERVO_CAL_PULSE_MAX_US      2500    /**< Pulse at the maximum angle. */
+#endif
+
+#ifndef SERVO_CAL_ANGLE_MIN_DDEG
+#define SERVO_CAL_ANGLE_MIN_DDEG    0       /**< Minimum angle in 0.1 degree. */
+#endif
+
+#ifndef SERVO_CAL_ANGLE_MAX_DDEG
+#define SERVO_CAL_ANGLE_MAX_DDEG    1800    /**< Maximum angle in 0.1 degree. */
+#endif
+
+#define SERVO_CAL_TRIM_MAX_US       200     /**< Largest trim in either direction. */
+
+#if (SERVO_CAL_PULSE_MAX_US <= SERVO_CAL_PULSE_MIN_US) || (SERVO_CAL_PULSE_MIN_US <= SERVO_CAL_TRIM_MAX_US) || \
+    (SERVO_CAL_PULSE_MAX_US + SERVO_CAL_TRIM_MAX_US > SERVO_PERIOD_US)
+#error "Invalid servo pulse range."
+#endif
+
+#if (SERVO_CAL_ANGLE_MAX_DDEG <= SERVO_CAL_ANGLE_MIN_DDEG) || (SERVO_CAL_ANGLE_MAX_DDEG - SERVO_CAL_ANGLE_MIN_DDEG >= 4095)
+#error "Invalid servo angle range, at most 409.4 degrees."
+#endif
+
+/**@brief Function for converting an angle to the pulse of a channel.
+ *
+ * @param[in]  channel      Channel index.
+ * @param[in]  angle_ddeg   Angle in 0.1 degree.
+ * @param[out] p_pulse_us   Pulse in microseconds, including the trim of the channel.
+ *
+ * @retval NRF_SUCCESS              The pulse has been computed.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or angle out of range.
+ */
+ret_code_t servo_cal_pulse_get(uint8_t channel, int16_t angle_ddeg, uint16_t * p_pulse_us);
+
+/**@brief Function for setting the trim of a channel.
+ *
+ * @details The trim is added to every pulse of the channel and compensates for
+ *          the mounting and the spread between servos.
+ *
+ * @param[in] channel   Channel index.
+ * @param[in] trim_us   Trim in microseconds, at most @ref SERVO_CAL_TRIM_MAX_US either way.
+ *
+ * @retval NRF_SUCCESS              The trim has been set. It applies from the next conversion.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or trim.
+ */
+ret_code_t servo_cal_trim_set(uint8_t channel, int16_t trim_us);
+
+/**@brief Function for setting a channel to an angle. See @ref servo_pulse_set.
+ *
+ * @retval NRF_SUCCESS              The pulse has been set.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or angle out of range.
+ * @return Errors from @ref servo_pulse_set.
+ */
+ret_code_t servo_cal_angle_set(uint8_t channel, int16_t angle_ddeg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_CAL_H__
+
+/** @} */
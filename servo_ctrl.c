@@ -0,0 +1,267 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "servo_ctrl.h"
+#include "servo.h"
+#include "servo_motion.h"
+#include "nrf_drv_qdec.h"
+#include "app_timer.h"
+#include "app_error.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+#include "nrf.h"
+
+APP_TIMER_DEF(m_ctrl_timer_id);
+
+static servo_ctrl_config_t  m_config;
+static volatile int32_t     m_position;
+static volatile int32_t     m_target;
+static int32_t              m_prev_position;
+static int32_t              m_integral;
+static bool                 m_running;
+static uint32_t             m_last_start;       // RTC ticks at the start of the previous run.
+static bool                 m_last_valid;       // False before the first run.
+
+static servo_ctrl_stats_t   m_stats;
+static uint64_t             m_exec_sum;
+
+
+static void stats_clear(void)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.exec_min_cycles = UINT32_MAX;
+    m_stats.interval_min_us = UINT32_MAX;
+    m_exec_sum              = 0;
+}
+
+
+static void qdec_event_handler(nrf_drv_qdec_event_t event)
+{
+    if (event.type == NRF_QDEC_EVENT_REPORTRDY)
+    {
+        m_position           += event.data.report.acc;
+        m_stats.double_trans += event.data.report.accdbl;
+        m_stats.reports++;
+    }
+    else if (event.type == NRF_QDEC_EVENT_ACCOF)
+    {
+        m_stats.overflows++;
+    }
+}
+
+
+static uint16_t pid_run(int32_t position)
+{
+    int32_t error = m_target - position;
+    int64_t u;
+    int32_t out;
+
+    m_integral = MAX(MIN(m_integral + error, SERVO_CTRL_INTEGRAL_MAX), -SERVO_CTRL_INTEGRAL_MAX);
+
+    u = (int64_t)m_config.kp * error +
+        (int64_t)m_config.ki * m_integral -
+        (int64_t)m_config.kd * (position - m_prev_position);
+
+    out = m_config.center_us + (int32_t)(u >> 16);
+
+    // Anti-windup: do not integrate into a saturated output.
+    if (((out > m_config.max_us) && (error > 0)) || ((out < m_config.min_us) && (error < 0)))
+    {
+        m_integral -= error;
+    }
+
+    m_prev_position = position;
+    m_stats.error   = error;
+
+    // The limits are checked against the default period, a mode change may shorten it.
+    return (uint16_t)MIN(MAX(MIN(out, m_config.max_us), m_config.min_us), servo_period_get());
+}
+
+
+static void ctrl_timeout_handler(void * p_context)
+{
+    uint32_t start  = DWT->CYCCNT;
+    uint32_t now    = app_timer_cnt_get();
+
+    UNUSED_PARAMETER(p_context);
+
+    if (m_last_valid)
+    {
+        uint32_t interval_us = (uint32_t)(((uint64_t)app_timer_cnt_diff_compute(now, m_last_start) * 1000000) /
+                                          APP_TIMER_CLOCK_FREQ);
+
+        m_stats.interval_min_us = MIN(m_stats.interval_min_us, interval_us);
+        m_stats.interval_max_us = MAX(m_stats.interval_max_us, interval_us);
+    }
+    m_last_start = now;
+    m_last_valid = true;
+
+    // The reports are the only reader of the accumulator. A READCLRACC from
+    // here would race the REPORTRDY to READCLRACC short of the driver.
+    (void)servo_pulse_set(m_config.channel, pid_run(m_position));
+
+    uint32_t cycles = DWT->CYCCNT - start;
+
+    m_stats.loops++;
+    m_stats.exec_min_cycles = MIN(m_stats.exec_min_cycles, cycles);
+    m_stats.exec_max_cycles = MAX(m_stats.exec_max_cycles, cycles);
+    m_exec_sum             += cycles;
+}
+
+
+ret_code_t servo_ctrl_init(servo_ctrl_config_t const * p_config)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_config);
+
+    if ((p_config->channel >= SERVO_CHANNEL_COUNT) ||
+        (p_config->min_us > p_config->center_us) || (p_config->center_us > p_config->max_us) ||
+        (p_config->max_us > SERVO_PERIOD_US))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_config   = *p_config;
+    m_position = 0;
+    m_target   = 0;
+    m_running  = false;
+    stats_clear();
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    nrf_drv_qdec_config_t const qdec_config =
+    {
+        .reportper          = SERVO_CTRL_QDEC_REPORTPER,
+        .sampleper          = SERVO_CTRL_QDEC_SAMPLEPER,
+        .psela              = SERVO_CTRL_QDEC_PIN_A,
+        .pselb              = SERVO_CTRL_QDEC_PIN_B,
+        .pselled            = NRF_QDEC_LED_NOT_CONNECTED,
+        .ledpre             = 0,
+        .ledpol             = NRF_QDEC_LEPOL_ACTIVE_HIGH,
+        .dbfen              = true,
+        .sample_inten       = false,
+        .interrupt_priority = APP_IRQ_PRIORITY_LOWEST
+    };
+
+    err_code = nrf_drv_qdec_init(&qdec_config, qdec_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    nrf_drv_qdec_enable();
+
+    return app_timer_create(&m_ctrl_timer_id, APP_TIMER_MODE_REPEATED, ctrl_timeout_handler);
+}
+
+
+ret_code_t servo_ctrl_start(void)
+{
+    ret_code_t err_code;
+
+    if (m_running)
+    {
+        return NRF_SUCCESS;
+    }
+
+    // The controller owns the channel from now on.
+    servo_motion_stop(m_config.channel);
+
+    m_prev_position = m_position;
+    m_integral      = 0;
+    m_last_valid    = false;
+    stats_clear();
+
+    err_code = app_timer_start(m_ctrl_timer_id, APP_TIMER_TICKS(SERVO_CTRL_PERIOD_MS), NULL);
+    VERIFY_SUCCESS(err_code);
+
+    m_running = true;
+
+    return NRF_SUCCESS;
+}
+
+
+void servo_ctrl_stop(void)
+{
+    if (m_running)
+    {
+        (void)app_timer_stop(m_ctrl_timer_id);
+        (void)servo_pulse_set(m_config.channel, m_config.center_us);
+        m_running = false;
+    }
+}
+
+
+bool servo_ctrl_running(void)
+{
+    return m_running;
+}
+
+
+void servo_ctrl_target_set(int32_t target)
+{
+    m_target = target;
+}
+
+
+int32_t servo_ctrl_position_get(void)
+{
+    return m_position;
+}
+
+
+void servo_ctrl_stats_get(servo_ctrl_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    p_stats->exec_avg_cycles = (m_stats.loops != 0) ? (uint32_t)(m_exec_sum / m_stats.loops) : 0;
+    if (m_stats.exec_min_cycles == UINT32_MAX)
+    {
+        p_stats->exec_min_cycles = 0;
+    }
+    if (m_stats.interval_min_us == UINT32_MAX)
+    {
+        p_stats->interval_min_us = 0;
+    }
+    stats_clear();
+    CRITICAL_REGION_EXIT();
+}
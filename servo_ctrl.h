@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup servo_ctrl Closed-loop servo control
+ * @{
+ * @brief Position control of a servo channel with quadrature encoder feedback.
+ *
+ * @details The encoder is read by the QDEC peripheral. Its accumulator
+ *          collects the transitions in hardware and reports them in batches of
+ *          @ref SERVO_CTRL_QDEC_REPORTPER samples, which only happens while
+ *          the encoder moves and keeps the accumulator from overflowing. The
+ *          reports are the only source of the position, and come more often
+ *          than the controller runs.
+ *
+ *          A PID controller runs every @ref SERVO_CTRL_PERIOD_MS from an
+ *          application timer. Each run takes the reported position, computes
+ *          the output in Q16.16 fixed point and writes the pulse of the
+ *          channel. The output is added to a center pulse: the stop pulse of a
+ *          continuous rotation servo or the neutral pulse of a motor driver. The integral stops growing while the output is saturated,
+ *          and the derivative acts on the position only, so target changes do
+ *          not kick the output.
+ *
+ *          The execution time of every run and the interval between runs are
+ *          recorded in @ref servo_ctrl_stats_t.
+ */
+
+#ifndef SERVO_CTRL_H__
+#define SERVO_CTRL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "nrf_qdec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERVO_CTRL_PERIOD_MS        20                          /**< Control period, one servo period. */
+#define SERVO_CTRL_QDEC_PIN_A       11                          /**< Encoder phase A. */
+#define SERVO_CTRL_QDEC_PIN_B       12                          /**< Encoder phase B. */
+#define SERVO_CTRL_QDEC_SAMPLEPER   NRF_QDEC_SAMPLEPER_128us    /**< Encoder sample period, up to 7800 transitions/s. */
+#define SERVO_CTRL_QDEC_REPORTPER   NRF_QDEC_REPORTPER_80       /**< Samples per report, 10.24 ms, within a control period. */
+#define SERVO_CTRL_INTEGRAL_MAX     100000                      /**< Limit of the error integral in counts times periods. */
+
+/**@brief Macro for converting a gain to Q16.16. */
+#define SERVO_CTRL_GAIN(value)      ((int32_t)((value) * 65536.0))
+
+/**@brief Controller configuration. Gains are per control period. */
+typedef struct
+{
+    uint8_t  channel;       /**< Servo channel driven by the controller. */
+    int32_t  kp;            /**< Proportional gain in us per count, Q16.16. */
+    int32_t  ki;            /**< Integral gain in us per count and period, Q16.16. */
+    int32_t  kd;            /**< Derivative gain in us per count change per period, Q16.16. */
+    uint16_t center_us;     /**< Pulse for zero output. */
+    uint16_t min_us;        /**< Lowest pulse. */
+    uint16_t max_us;        /**< Highest pulse. */
+} servo_ctrl_config_t;
+
+/**@brief Default configuration for a continuous rotation servo on channel 0. */
+#define SERVO_CTRL_DEFAULT_CONFIG               \
+{                                               \
+    .channel   = 0,                             \
+    .kp        = SERVO_CTRL_GAIN(2.0),          \
+    .ki        = SERVO_CTRL_GAIN(0.05),         \
+    .kd        = SERVO_CTRL_GAIN(1.0),          \
+    .center_us = 1500,                          \
+    .min_us    = 1000,                          \
+    .max_us    = 2000                           \
+}
+
+/**@brief Control statistics. */
+typedef struct
+{
+    uint32_t loops;             /**< Number of control runs. */
+    uint32_t reports;           /**< Number of QDEC reports. */
+    uint32_t overflows;         /**< Number of accumulator overflows, counts have been lost. */
+    uint32_t double_trans;      /**< Number of double transitions, counts have been lost. */
+    uint32_t exec_min_cycles;   /**< Shortest run in CPU cycles. */
+    uint32_t exec_max_cycles;   /**< Longest run in CPU cycles. */
+    uint32_t exec_avg_cycles;   /**< Average run in CPU cycles. */
+    uint32_t interval_min_us;   /**< Shortest time between the start of two runs. */
+    uint32_t interval_max_us;   /**< Longest time between the start of two runs. */
+    int32_t  error;             /**< Position error of the last run in counts. */
+} servo_ctrl_stats_t;
+
+/**@brief Function for initializing the encoder and the controller.
+ *
+ * @details Requires the application timer module and the @ref servo module to
+ *          be initialized. The encoder is counted from here on, the controller
+ *          is started with @ref servo_ctrl_start.
+ *
+ * @param[in] p_config  Configuration.
+ *
+ * @retval NRF_SUCCESS              The controller is ready.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or pulse limits.
+ * @return Errors from @ref nrf_drv_qdec_init and @ref app_timer_create.
+ */
+ret_code_t servo_ctrl_init(servo_ctrl_config_t const * p_config);
+
+/**@brief Function for starting the controller at the current position.
+ *
+ * @retval NRF_SUCCESS  The controller runs.
+ * @return Errors from @ref app_timer_start.
+ */
+ret_code_t servo_ctrl_start(void);
+
+/**@brief Function for stopping the controller. The channel is left at the center pulse. */
+void servo_ctrl_stop(void);
+
+/**@brief Function for checking if the controller runs. */
+bool servo_ctrl_running(void);
+
+/**@brief Function for setting the target position in encoder counts. */
+void servo_ctrl_target_set(int32_t target);
+
+/**@brief Function for getting the position in encoder counts. */
+int32_t servo_ctrl_position_get(void);
+
+/**@brief Function for reading and clearing the control statistics.
+ *
+ * @param[out] p_stats  Statistics since the last call.
+ */
+void servo_ctrl_stats_get(servo_ctrl_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_CTRL_H__
+
+/** @} */
@@ -0,0 +1,333 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stddef.h>
+
+#include "servo_motion.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+#include "nordic_common.h"
+
+#define Q16_ONE     (1L << 16)
+
+/**@brief Trajectory state of a channel. Positions in Q16.16 us, speeds per tick. */
+typedef struct
+{
+    servo_motion_limits_t limits;
+    int32_t               pos;
+    int32_t               target;
+    int32_t               vel;          // Trapezoid: current speed, signed.
+    int32_t               vel_max;      // Trapezoid: speed limit.
+    int32_t               accel;        // Trapezoid: acceleration limit.
+    int32_t               start;        // S-curve: start position.
+    uint32_t              step;         // S-curve: ticks done.
+    uint32_t              steps;        // S-curve: duration in ticks.
+    bool                  busy;
+} axis_t;
+
+APP_TIMER_DEF(m_tick_timer_id);
+
+static axis_t m_axes[SERVO_CHANNEL_COUNT];
+static bool   m_running;
+
+
+static int32_t abs32(int32_t value)
+{
+    return (value < 0) ? -value : value;
+}
+
+
+static uint32_t isqrt(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit    = 1ULL << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value  -= result + bit;
+            result  = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)result;
+}
+
+
+// Speed limit in Q16.16 us per tick, at least one LSB.
+static int32_t vel_per_tick(uint32_t speed)
+{
+    uint64_t vel = ((uint64_t)speed * SERVO_MOTION_TICK_MS * Q16_ONE) / 1000;
+
+    return (int32_t)MAX(MIN(vel, (uint64_t)(20000L * Q16_ONE)), 1);
+}
+
+
+// Acceleration limit in Q16.16 us per tick^2, at least one LSB.
+static int32_t accel_per_tick(uint32_t accel)
+{
+    uint64_t acc = ((uint64_t)accel * SERVO_MOTION_TICK_MS * SERVO_MOTION_TICK_MS * Q16_ONE) / 1000000;
+
+    return (int32_t)MAX(MIN(acc, (uint64_t)(20000L * Q16_ONE)), 1);
+}
+
+
+static void trapezoid_step(axis_t * p_axis)
+{
+    int32_t err = p_axis->target - p_axis->pos;
+    int32_t vel = p_axis->vel;
+    int32_t acc = p_axis->accel;
+
+    // Within one acceleration step of the target and nearly at rest: arrive.
+    if ((abs32(err) <= acc) && (abs32(vel) <= acc))
+    {
+        p_axis->pos  = p_axis->target;
+        p_axis->vel  = 0;
+        p_axis->busy = false;
+        return;
+    }
+
+    // Distance covered while braking from the current speed in whole ticks.
+    int64_t brake = ((int64_t)abs32(vel) * (abs32(vel) + acc)) / (2 * (int64_t)acc);
+
+    if ((vel != 0) && (((vel > 0) != (err > 0)) || (brake >= abs32(err))))
+    {
+        // Moving away from the target or about to overshoot it.
+        vel = (vel > 0) ? MAX(vel - acc, 0) : MIN(vel + acc, 0);
+    }
+    else
+    {
+        vel = (err > 0) ? MIN(vel + acc, p_axis->vel_max) : MAX(vel - acc, -p_axis->vel_max);
+    }
+
+    p_axis->vel  = vel;
+    p_axis->pos += vel;
+}
+
+
+static void scurve_step(axis_t * p_axis)
+{
+    p_axis->step++;
+    if (p_axis->step >= p_axis->steps)
+    {
+        p_axis->pos  = p_axis->target;
+        p_axis->busy = false;
+        return;
+    }
+
+    // s(u) = 3u^2 - 2u^3 with u = step / steps, in Q16.
+    int64_t u = ((int64_t)p_axis->step << 16) / p_axis->steps;
+    int64_t s = (((u * u) >> 16) * (3 * Q16_ONE - 2 * u)) >> 16;
+
+    p_axis->pos = p_axis->start + (int32_t)(((int64_t)(p_axis->target - p_axis->start) * s) >> 16);
+}
+
+
+// The smoothstep peaks at 1.5 d/T in speed and 6 d/T^2 in acceleration.
+static uint32_t scurve_steps(axis_t const * p_axis)
+{
+    uint64_t dist     = (uint64_t)abs32(p_axis->target - p_axis->start);
+    uint64_t by_speed = (3 * dist + 2 * (uint64_t)p_axis->vel_max - 1) / (2 * (uint64_t)p_axis->vel_max);
+    uint64_t by_accel = isqrt((6 * dist + (uint64_t)p_axis->accel - 1) / (uint64_t)p_axis->accel) + 1;
+
+    return (uint32_t)MAX(MAX(by_speed, by_accel), 1);
+}
+
+
+static void tick_handler(void * p_context)
+{
+    bool busy = false;
+
+    UNUSED_PARAMETER(p_context);
+
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        axis_t * p_axis = &m_axes[i];
+
+        if (!p_axis->busy)
+        {
+            continue;
+        }
+
+        if (p_axis->limits.profile == SERVO_MOTION_PROFILE_SCURVE)
+        {
+            scurve_step(p_axis);
+        }
+        else
+        {
+            trapezoid_step(p_axis);
+        }
+
+        // A mode change may have shortened the period under a running move.
+        uint16_t pulse = (uint16_t)((p_axis->pos + Q16_ONE / 2) >> 16);
+        pulse = MIN(pulse, servo_period_get());
+        if (pulse != servo_pulse_get(i))
+        {
+            (void)servo_pulse_set(i, pulse);
+        }
+
+        busy |= p_axis->busy;
+    }
+
+    if (!busy)
+    {
+        (void)app_timer_stop(m_tick_timer_id);
+        m_running = false;
+    }
+}
+
+
+ret_code_t servo_motion_init(void)
+{
+    servo_motion_limits_t const limits =
+    {
+        .speed   = SERVO_MOTION_DEFAULT_SPEED,
+        .accel   = SERVO_MOTION_DEFAULT_ACCEL,
+        .profile = SERVO_MOTION_PROFILE_TRAPEZOID
+    };
+
+    for (uint32_t i = 0; i < SERVO_CHANNEL_COUNT; i++)
+    {
+        m_axes[i].limits = limits;
+        m_axes[i].busy   = false;
+    }
+    m_running = false;
+
+    return app_timer_create(&m_tick_timer_id, APP_TIMER_MODE_REPEATED, tick_handler);
+}
+
+
+ret_code_t servo_motion_limits_set(uint8_t channel, servo_motion_limits_t const * p_limits)
+{
+    VERIFY_PARAM_NOT_NULL(p_limits);
+
+    if ((channel >= SERVO_CHANNEL_COUNT) || (p_limits->speed == 0) || (p_limits->accel == 0))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_axes[channel].limits = *p_limits;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t servo_motion_move(uint8_t channel, uint16_t target_us)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+
+    if ((channel >= SERVO_CHANNEL_COUNT) || (target_us > servo_period_get()))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    axis_t * p_axis  = &m_axes[channel];
+    uint16_t current = servo_pulse_get(channel);
+
+    if (current == 0)
+    {
+        p_axis->busy = false;
+        return servo_pulse_set(channel, target_us);
+    }
+
+    // The tick must not run on a half set up axis.
+    CRITICAL_REGION_ENTER();
+
+    if (!p_axis->busy)
+    {
+        p_axis->pos = (int32_t)current << 16;
+        p_axis->vel = 0;
+    }
+
+    p_axis->target  = (int32_t)target_us << 16;
+    p_axis->vel_max = vel_per_tick(p_axis->limits.speed);
+    p_axis->accel   = accel_per_tick(p_axis->limits.accel);
+
+    if (p_axis->limits.profile == SERVO_MOTION_PROFILE_SCURVE)
+    {
+        p_axis->start = p_axis->pos;
+        p_axis->vel   = 0;
+        p_axis->step  = 0;
+        p_axis->steps = scurve_steps(p_axis);
+    }
+
+    p_axis->busy = true;
+
+    if (!m_running)
+    {
+        err_code  = app_timer_start(m_tick_timer_id, APP_TIMER_TICKS(SERVO_MOTION_TICK_MS), NULL);
+        m_running = (err_code == NRF_SUCCESS);
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+}
+
+
+void servo_motion_stop(uint8_t channel)
+{
+    if (channel < SERVO_CHANNEL_COUNT)
+    {
+        CRITICAL_REGION_ENTER();
+        m_axes[channel].busy = false;
+        m_axes[channel].vel  = 0;
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+
+bool servo_motion_busy(uint8_t channel)
+{
+    return (channel < SERVO_CHANNEL_COUNT) && m_axes[channel].busy;
+}
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup servo_motion Servo motion planner
+ * @{
+ * @brief Non-blocking moves of the @ref servo outputs with speed and acceleration limits.
+ *
+ * @details A move only records a target. The trajectory is advanced from an
+ *          application timer every @ref SERVO_MOTION_TICK_MS, which matches
+ *          the servo period, and the timer only runs while a channel is moving.
+ *
+ *          Two profiles are available:
+ *          - Trapezoid: accelerates to the speed limit, cruises and brakes so
+ *            that it stops at the target. A new target can be given at any time
+ *            and the move continues from the current position and speed.
+ *          - S-curve: a smoothstep profile whose duration is chosen so that
+ *            neither limit is exceeded. Speed and acceleration are continuous
+ *            within a move. A new target starts a new move from the current
+ *            position at rest.
+ *
+ *          Positions are pulse widths in microseconds. Internally they are kept
+ *          as Q16.16 fixed point per tick, so slow moves are smooth.
+ *
+ *          The functions can be called from thread mode and from interrupts.
+ *          The axis state is only changed inside critical regions, so the
+ *          tick never sees a move half set up.
+ */
+
+#ifndef SERVO_MOTION_H__
+#define SERVO_MOTION_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "sdk_errors.h"
+#include "servo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERVO_MOTION_TICK_MS            20      /**< Trajectory update interval, one servo period. */
+#define SERVO_MOTION_DEFAULT_SPEED      2000    /**< Default speed limit in us/s. */
+#define SERVO_MOTION_DEFAULT_ACCEL      8000    /**< Default acceleration limit in us/s^2. */
+
+/**@brief Trajectory profile. */
+typedef enum
+{
+    SERVO_MOTION_PROFILE_TRAPEZOID,     /**< Constant acceleration, cruise, constant deceleration. */
+    SERVO_MOTION_PROFILE_SCURVE,        /**< Smoothstep, continuous acceleration. */
+} servo_motion_profile_t;
+
+/**@brief Motion limits of a channel. */
+typedef struct
+{
+    uint32_t               speed;       /**< Speed limit in us/s. */
+    uint32_t               accel;       /**< Acceleration limit in us/s^2. */
+    servo_motion_profile_t profile;     /**< Trajectory profile. */
+} servo_motion_limits_t;
+
+/**@brief Function for initializing the planner.
+ *
+ * @details Requires the application timer module and the @ref servo module to
+ *          be initialized. All channels get the default limits and the
+ *          trapezoid profile.
+ *
+ * @retval NRF_SUCCESS  The planner is ready.
+ * @return Errors from @ref app_timer_create.
+ */
+ret_code_t servo_motion_init(void);
+
+/**@brief Function for setting the limits of a channel. Applies from the next move.
+ *
+ * @retval NRF_SUCCESS              The limits have been set.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel, or a limit is 0.
+ */
+ret_code_t servo_motion_limits_set(uint8_t channel, servo_motion_limits_t const * p_limits);
+
+/**@brief Function for moving a channel to a new position.
+ *
+ * @details Returns immediately. A channel that outputs no pulse has no known
+ *          position, so it jumps to the target.
+ *
+ * @param[in] channel   Channel index.
+ * @param[in] target_us Target pulse width in microseconds.
+ *
+ * @retval NRF_SUCCESS              The move has started.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid channel or target.
+ * @return Errors from @ref app_timer_start and @ref servo_pulse_set.
+ */
+ret_code_t servo_motion_move(uint8_t channel, uint16_t target_us);
+
+/**@brief Function for stopping a channel at its current position. */
+void servo_motion_stop(uint8_t channel);
+
+/**@brief Function for checking if a channel is moving. */
+bool servo_motion_busy(uint8_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_MOTION_H__
+
+/** @} */
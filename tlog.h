@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup tlog Tokenized logging
+ * @{
+ * @brief Log messages sent as a format string token plus raw argument words.
+ *
+ * @details @ref TLOG places the format string in the .tlog_fmt section instead
+ *          of formatting it on the device. The armgcc linker script links that
+ *          section as non-loaded INFO data at address 0, so the string costs no
+ *          flash and its address is a unique 16-bit token. The build dumps the
+ *          section to <target>.tlog next to the hex file; that file is the
+ *          token table used by tools/tlog_decode.
+ *
+ *          A log call sends one @ref uart_frame frame of type @ref TLOG_FRAME_TYPE
+ *          holding the token (uint16) and each argument as a uint32, all
+ *          little-endian. Integers, characters and pointers can be logged, each
+ *          argument is cast to uint32_t by the macro; strings and floating point
+ *          values cannot.
+ *
+ *          Only the armgcc project generates the token table.
+ */
+
+#ifndef TLOG_H__
+#define TLOG_H__
+
+#include <stdint.h>
+
+#include "app_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TLOG_ENABLED
+#define TLOG_ENABLED        1       /**< Set to 0 to compile all @ref TLOG calls out. */
+#endif
+
+#define TLOG_MAX_ARGS       6       /**< Maximum number of arguments of a log call. */
+#define TLOG_FRAME_TYPE     0x30    /**< Frame type of a log message. */
+
+/**@brief Function for sending a log message. Use @ref TLOG instead.
+ *
+ * @param[in] token     Address of the format string in the .tlog_fmt section.
+ * @param[in] p_args    Arguments.
+ * @param[in] nargs     Number of arguments.
+ */
+void tlog_write(uint32_t token, uint32_t const * p_args, uint32_t nargs);
+
+/**@brief Macros casting each argument of @ref TLOG to uint32_t, pointers included. */
+#define TLOG_ARG(x)                         (uint32_t)(uintptr_t)(x)
+#define TLOG_ARGS_0()
+#define TLOG_ARGS_1(a)                      , TLOG_ARG(a)
+#define TLOG_ARGS_2(a, b)                   TLOG_ARGS_1(a), TLOG_ARG(b)
+#define TLOG_ARGS_3(a, b, c)                TLOG_ARGS_2(a, b), TLOG_ARG(c)
+#define TLOG_ARGS_4(a, b, c, d)             TLOG_ARGS_3(a, b, c), TLOG_ARG(d)
+#define TLOG_ARGS_5(a, b, c, d, e)          TLOG_ARGS_4(a, b, c, d), TLOG_ARG(e)
+#define TLOG_ARGS_6(a, b, c, d, e, f)       TLOG_ARGS_5(a, b, c, d, e), TLOG_ARG(f)
+#define TLOG_ARGS_SELECT(_0, _1, _2, _3, _4, _5, _6, N, ...)  N
+#define TLOG_ARGS(...)                                                                          \
+    TLOG_ARGS_SELECT(_0, ##__VA_ARGS__, TLOG_ARGS_6, TLOG_ARGS_5, TLOG_ARGS_4, TLOG_ARGS_3,    \
+                     TLOG_ARGS_2, TLOG_ARGS_1, TLOG_ARGS_0)(__VA_ARGS__)
+
+#if TLOG_ENABLED
+/**@brief Macro for logging a message.
+ *
+ * @details Safe to use in interrupt context. Arguments are cast to uint32_t.
+ *
+ * @param[in] fmt   printf style format string literal.
+ * @param[in] ...   Up to @ref TLOG_MAX_ARGS integer arguments.
+ */
+#define TLOG(fmt, ...)                                                                          \
+    do                                                                                          \
+    {                                                                                           \
+        static const char tlog_fmt[] __attribute__((section(".tlog_fmt"), used)) = fmt;         \
+        uint32_t const    tlog_args[] = { 0 TLOG_ARGS(__VA_ARGS__) };                           \
+        STATIC_ASSERT(ARRAY_SIZE(tlog_args) - 1 <= TLOG_MAX_ARGS);                              \
+        tlog_write((uint32_t)(uintptr_t)tlog_fmt, &tlog_args[1], ARRAY_SIZE(tlog_args) - 1);     \
+    } while (0)
+#else
+#define TLOG(fmt, ...)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TLOG_H__
+
+/** @} */
@@ -0,0 +1,232 @@
+/*
+ * Host decoder for tokenized log messages, see tlog.h.
+ *
+ * Reads the UART byte stream, extracts the SLIP frames of uart_frame.h and
+ * prints every log frame with its format string looked up in the token table
+ * produced by the armgcc build (_build/<target>.tlog).
+ *
+ *   c++ -std=c++11 -O2 -o tlog_decode tlog_decode.cpp
+ *   stty -F /dev/ttyACM0 115200 raw && ./tlog_decode _build/nrf52832_xxaa.tlog /dev/ttyACM0
+ *
+ * Without an input file the stream is read from stdin.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const uint8_t SLIP_END        = 0xC0;
+const uint8_t SLIP_ESC        = 0xDB;
+const uint8_t SLIP_ESC_END    = 0xDC;
+const uint8_t SLIP_ESC_ESC    = 0xDD;
+const uint8_t TLOG_FRAME_TYPE = 0x30;
+
+// CRC16-CCITT as computed by the nRF5 SDK crc16 library.
+uint16_t crc16(std::vector<uint8_t> const & data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        crc  = (uint8_t)(crc >> 8) | (crc << 8);
+        crc ^= data[i];
+        crc ^= (uint8_t)(crc & 0xFF) >> 4;
+        crc ^= (crc << 8) << 4;
+        crc ^= ((crc & 0xFF) << 4) << 1;
+    }
+
+    return crc;
+}
+
+uint32_t le32(std::vector<uint8_t> const & data, size_t offset)
+{
+    return  (uint32_t)data[offset]             | ((uint32_t)data[offset + 1] << 8) |
+           ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+}
+
+// Expands a printf style format string with 32-bit argument words.
+std::string format(std::string const & fmt, std::vector<uint32_t> const & args)
+{
+    std::string out;
+    size_t      next = 0;
+
+    for (size_t i = 0; i < fmt.size(); i++)
+    {
+        if (fmt[i] != '%')
+        {
+            out += fmt[i];
+            continue;
+        }
+
+        size_t start = i++;
+        while ((i < fmt.size()) && (std::string("-+ #0123456789.hlzjt").find(fmt[i]) != std::string::npos))
+        {
+            i++;
+        }
+        if (i >= fmt.size())
+        {
+            break;
+        }
+        if (fmt[i] == '%')
+        {
+            out += '%';
+            continue;
+        }
+
+        // Drop length modifiers, every argument is a 32-bit word.
+        std::string spec;
+        for (size_t j = start; j < i; j++)
+        {
+            if (std::string("hlzjt").find(fmt[j]) == std::string::npos)
+            {
+                spec += fmt[j];
+            }
+        }
+
+        uint32_t arg = (next < args.size()) ? args[next++] : 0;
+        char     buf[64];
+
+        switch (fmt[i])
+        {
+            case 'd':
+            case 'i':
+                std::snprintf(buf, sizeof(buf), (spec + "d").c_str(), (int32_t)arg);
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+            case 'c':
+                std::snprintf(buf, sizeof(buf), (spec + fmt[i]).c_str(), arg);
+                break;
+
+            case 'p':
+                std::snprintf(buf, sizeof(buf), "0x%08x", arg);
+                break;
+
+            default:
+                std::snprintf(buf, sizeof(buf), "<%%%c unsupported>", fmt[i]);
+                break;
+        }
+        out += buf;
+    }
+
+    return out;
+}
+
+class Decoder
+{
+public:
+    explicit Decoder(std::vector<char> const & table) : m_table(table), m_esc(false) {}
+
+    void input(uint8_t byte)
+    {
+        if (byte == SLIP_END)
+        {
+            frame_end();
+        }
+        else if (m_esc)
+        {
+            m_esc = false;
+            m_frame.push_back((byte == SLIP_ESC_END) ? SLIP_END : SLIP_ESC);
+        }
+        else if (byte == SLIP_ESC)
+        {
+            m_esc = true;
+        }
+        else
+        {
+            m_frame.push_back(byte);
+        }
+    }
+
+private:
+    void frame_end()
+    {
+        size_t length = m_frame.size();
+
+        if ((length >= 5) &&
+            (m_frame[0] == TLOG_FRAME_TYPE) &&
+            ((length - 5) % 4 == 0) &&
+            (crc16(m_frame, length - 2) == (m_frame[length - 2] | (m_frame[length - 1] << 8))))
+        {
+            uint16_t              token = m_frame[1] | (m_frame[2] << 8);
+            std::vector<uint32_t> args;
+
+            for (size_t i = 3; i < length - 2; i += 4)
+            {
+                args.push_back(le32(m_frame, i));
+            }
+
+            print(token, args);
+        }
+
+        m_frame.clear();
+        m_esc = false;
+    }
+
+    void print(uint16_t token, std::vector<uint32_t> const & args)
+    {
+        if (token >= m_table.size())
+        {
+            std::cout << "<unknown token " << token << ">" << std::endl;
+            return;
+        }
+
+        std::string text = format(std::string(&m_table[token]), args);
+        while (!text.empty() && ((text.back() == '\n') || (text.back() == '\r') || (text.back() == ' ')))
+        {
+            text.pop_back();
+        }
+        std::cout << text << std::endl;
+    }
+
+    std::vector<char>    m_table;
+    std::vector<uint8_t> m_frame;
+    bool                 m_esc;
+};
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        std::cerr << "usage: " << argv[0] << " <token table> [input]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream table_file(argv[1], std::ios::binary);
+    if (!table_file)
+    {
+        std::cerr << "cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<char> table((std::istreambuf_iterator<char>(table_file)), std::istreambuf_iterator<char>());
+    table.push_back('\0');
+
+    FILE * p_input = (argc == 3) ? std::fopen(argv[2], "rb") : stdin;
+    if (p_input == nullptr)
+    {
+        std::cerr << "cannot open " << argv[2] << std::endl;
+        return 1;
+    }
+
+    Decoder decoder(table);
+    int     c;
+
+    while ((c = std::fgetc(p_input)) != EOF)
+    {
+        decoder.input((uint8_t)c);
+    }
+
+    return 0;
+}
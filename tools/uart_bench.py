@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""Host side of the UART benchmark suite (nrf52832_xxaa_bench target).
+
+For every rate the board is switched with the baud negotiation of uart_baud.h
+and the suite of uart_bench.h is run: echo frames are sent back, data is
+streamed when the board asks for it, and every result is printed as one JSON
+object per line.
+
+    python3 uart_bench.py /dev/ttyACM0 --hwfc --duration 5000
+
+Requires pyserial.
+"""
+import argparse
+import json
+import struct
+import time
+
+import serial
+
+SLIP_END, SLIP_ESC, SLIP_ESC_END, SLIP_ESC_ESC = 0xC0, 0xDB, 0xDC, 0xDD
+
+FRAME_BAUD_REQUEST, FRAME_BAUD_ACK, FRAME_BAUD_NACK, FRAME_BAUD_CONFIRM = 0x10, 0x11, 0x12, 0x13
+FRAME_BENCH_START, FRAME_BENCH_RESULT, FRAME_BENCH_ECHO = 0x20, 0x21, 0x22
+FRAME_BENCH_RX_REQUEST, FRAME_BENCH_DONE = 0x23, 0x24
+FLAG_HWFC = 0x01
+
+RATES = [115200, 230400, 460800, 921600, 1000000]
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC16-CCITT as computed by the nRF5 SDK crc16 library."""
+    for b in data:
+        crc = ((crc >> 8) | (crc << 8)) & 0xFFFF
+        crc ^= b
+        crc ^= (crc & 0xFF) >> 4
+        crc ^= (crc << 12) & 0xFFFF
+        crc ^= ((crc & 0xFF) << 5) & 0xFFFF
+    return crc
+
+
+def encode(frame_type, payload=b""):
+    body = bytes([frame_type]) + payload
+    body += struct.pack("<H", crc16(body))
+    out = bytearray([SLIP_END])
+    for b in body:
+        if b == SLIP_END:
+            out += bytes([SLIP_ESC, SLIP_ESC_END])
+        elif b == SLIP_ESC:
+            out += bytes([SLIP_ESC, SLIP_ESC_ESC])
+        else:
+            out.append(b)
+    out.append(SLIP_END)
+    return bytes(out)
+
+
+class Link:
+    def __init__(self, port):
+        self.ser = serial.Serial(port, 115200, timeout=0.1)
+        self.frame = bytearray()
+        self.esc = False
+
+    def send(self, frame_type, payload=b""):
+        self.ser.write(encode(frame_type, payload))
+
+    def receive(self, wanted, timeout):
+        """Return (type, payload) of the first valid frame with a type in wanted."""
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            for b in self.ser.read(self.ser.in_waiting or 1):
+                if b == SLIP_END:
+                    frame, self.frame = bytes(self.frame), bytearray()
+                    if len(frame) >= 3 and crc16(frame[:-2]) == struct.unpack("<H", frame[-2:])[0]:
+                        if frame[0] in wanted:
+                            return frame[0], frame[1:-2]
+                elif self.esc:
+                    self.esc = False
+                    self.frame.append(SLIP_END if b == SLIP_ESC_END else SLIP_ESC)
+                elif b == SLIP_ESC:
+                    self.esc = True
+                else:
+                    self.frame.append(b)
+        return None, None
+
+    def switch(self, bps, hwfc):
+        settings = struct.pack("<IB", bps, FLAG_HWFC if hwfc else 0)
+        self.send(FRAME_BAUD_REQUEST, settings)
+        frame_type, _ = self.receive((FRAME_BAUD_ACK, FRAME_BAUD_NACK), 1.0)
+        if frame_type != FRAME_BAUD_ACK:
+            return False
+        previous = (self.ser.baudrate, self.ser.rtscts)
+        # Give the board time to restart the UARTE before talking at the new rate.
+        time.sleep(0.05)
+        self.ser.baudrate = bps
+        self.ser.rtscts = hwfc
+        self.ser.reset_input_buffer()
+        self.send(FRAME_BAUD_CONFIRM, settings)
+        frame_type, _ = self.receive((FRAME_BAUD_CONFIRM,), 0.5)
+        if frame_type != FRAME_BAUD_CONFIRM:
+            # The board falls back to the previous settings after its confirmation timeout.
+            time.sleep(1.0)
+            self.ser.baudrate, self.ser.rtscts = previous
+            return False
+        return True
+
+
+def run_suite(link, bps, duration_ms):
+    wanted = (FRAME_BENCH_RESULT, FRAME_BENCH_ECHO, FRAME_BENCH_RX_REQUEST, FRAME_BENCH_DONE)
+    # Printable filler, free of SLIP special bytes.
+    filler = bytes(range(0x21, 0x7F)) * 8
+
+    link.send(FRAME_BENCH_START, struct.pack("<I", duration_ms))
+    while True:
+        frame_type, payload = link.receive(wanted, duration_ms / 1000 + 2)
+        if frame_type is None:
+            print(json.dumps({"test": "error", "bps": bps, "error": "timeout"}))
+            return
+        if frame_type == FRAME_BENCH_ECHO:
+            link.send(FRAME_BENCH_ECHO, payload)
+        elif frame_type == FRAME_BENCH_RX_REQUEST:
+            (ms,) = struct.unpack("<I", payload)
+            end = time.monotonic() + ms / 1000 + 0.2
+            while time.monotonic() < end:
+                link.ser.write(filler)
+            # Close the stream so the board's frame decoder resyncs.
+            link.ser.write(bytes([SLIP_END]))
+        else:
+            result = json.loads(payload.decode())
+            result["bps"] = bps
+            print(json.dumps(result), flush=True)
+            if frame_type == FRAME_BENCH_DONE:
+                return
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port")
+    parser.add_argument("--duration", type=int, default=5000, help="run time per rate in ms")
+    parser.add_argument("--hwfc", action="store_true", help="enable RTS/CTS flow control")
+    args = parser.parse_args()
+
+    link = Link(args.port)
+    for bps in RATES:
+        if not link.switch(bps, args.hwfc):
+            print(f"rate={bps} error=switch_failed")
+            continue
+        run_suite(link, bps, args.duration)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,247 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include "uart_baud.h"
+#include "uart_dma.h"
+#include "uart_frame.h"
+#include "app_timer.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "app_error.h"
+#include "nordic_common.h"
+
+#define BAUD_PAYLOAD_LEN    5   // uint32 bits/s + flags.
+
+/**@brief Negotiation state. */
+typedef enum
+{
+    BAUD_STATE_IDLE,
+    BAUD_STATE_SWITCH_PENDING,  // The answer is queued, switch once it has been sent.
+    BAUD_STATE_CONFIRM_WAIT,    // Running at the new rate, waiting for the host.
+    BAUD_STATE_REVERT_PENDING,  // The host did not confirm, go back.
+} baud_state_t;
+
+/**@brief Supported rate. */
+typedef struct
+{
+    uint32_t            bps;
+    nrf_uart_baudrate_t baudrate;
+} baud_rate_t;
+
+static const baud_rate_t m_rates[] =
+{
+    { 115200,  NRF_UART_BAUDRATE_115200  },
+    { 230400,  NRF_UART_BAUDRATE_230400  },
+    { 460800,  NRF_UART_BAUDRATE_460800  },
+    { 921600,  NRF_UART_BAUDRATE_921600  },
+    { 1000000, NRF_UART_BAUDRATE_1000000 },
+};
+
+APP_TIMER_DEF(m_confirm_timer_id);
+
+static volatile baud_state_t m_state;
+static baud_rate_t const *   mp_current;
+static bool                  m_current_hwfc;
+static baud_rate_t const *   mp_previous;
+static bool                  m_previous_hwfc;
+
+
+static nrf_uart_hwfc_t hwfc_get(bool enabled)
+{
+    return enabled ? NRF_UART_HWFC_ENABLED : NRF_UART_HWFC_DISABLED;
+}
+
+
+static baud_rate_t const * rate_find(uint32_t bps)
+{
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_rates); i++)
+    {
+        if (m_rates[i].bps == bps)
+        {
+            return &m_rates[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+static void settings_send(uint8_t type, baud_rate_t const * p_rate, bool hwfc)
+{
+    uint8_t payload[BAUD_PAYLOAD_LEN];
+
+    (void)uint32_encode(p_rate->bps, payload);
+    payload[4] = hwfc ? UART_BAUD_FLAG_HWFC : 0;
+
+    (void)uart_frame_send(type, payload, sizeof(payload));
+}
+
+
+static void confirm_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    if (m_state == BAUD_STATE_CONFIRM_WAIT)
+    {
+        m_state = BAUD_STATE_REVERT_PENDING;
+    }
+}
+
+
+ret_code_t uart_baud_init(nrf_uart_baudrate_t baudrate, nrf_uart_hwfc_t hwfc)
+{
+    mp_current = &m_rates[0];
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_rates); i++)
+    {
+        if (m_rates[i].baudrate == baudrate)
+        {
+            mp_current = &m_rates[i];
+        }
+    }
+    m_current_hwfc = (hwfc == NRF_UART_HWFC_ENABLED);
+    m_state        = BAUD_STATE_IDLE;
+
+    return app_timer_create(&m_confirm_timer_id, APP_TIMER_MODE_SINGLE_SHOT, confirm_timeout_handler);
+}
+
+
+bool uart_baud_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length)
+{
+    baud_rate_t const * p_rate;
+    bool                confirmed;
+
+    switch (type)
+    {
+        case UART_BAUD_FRAME_REQUEST:
+            p_rate = (length == BAUD_PAYLOAD_LEN) ? rate_find(uint32_decode(p_payload)) : NULL;
+
+            if ((p_rate == NULL) || (m_state != BAUD_STATE_IDLE))
+            {
+                settings_send(UART_BAUD_FRAME_NACK, mp_current, m_current_hwfc);
+                break;
+            }
+
+            mp_previous     = mp_current;
+            m_previous_hwfc = m_current_hwfc;
+            mp_current      = p_rate;
+            m_current_hwfc  = (p_payload[4] & UART_BAUD_FLAG_HWFC) != 0;
+
+            settings_send(UART_BAUD_FRAME_ACK, mp_current, m_current_hwfc);
+            m_state = BAUD_STATE_SWITCH_PENDING;
+            break;
+
+        case UART_BAUD_FRAME_CONFIRM:
+            // Races the timeout, only one of them may end the wait.
+            CRITICAL_REGION_ENTER();
+            confirmed = (m_state == BAUD_STATE_CONFIRM_WAIT);
+            if (confirmed)
+            {
+                m_state = BAUD_STATE_IDLE;
+            }
+            CRITICAL_REGION_EXIT();
+
+            if (confirmed)
+            {
+                (void)app_timer_stop(m_confirm_timer_id);
+                settings_send(UART_BAUD_FRAME_CONFIRM, mp_current, m_current_hwfc);
+            }
+            else if (m_state == BAUD_STATE_REVERT_PENDING)
+            {
+                // Too late, tell the host which settings the board goes back to.
+                settings_send(UART_BAUD_FRAME_NACK, mp_previous, m_previous_hwfc);
+            }
+            else
+            {
+                settings_send(UART_BAUD_FRAME_NACK, mp_current, m_current_hwfc);
+            }
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+
+void uart_baud_process(void)
+{
+    ret_code_t err_code;
+
+    switch (m_state)
+    {
+        case BAUD_STATE_SWITCH_PENDING:
+            // Arm the fallback first, the confirmation may arrive as soon as the UARTE is restarted.
+            m_state  = BAUD_STATE_CONFIRM_WAIT;
+            err_code = app_timer_start(m_confirm_timer_id,
+                                       APP_TIMER_TICKS(UART_BAUD_CONFIRM_TIMEOUT_MS),
+                                       NULL);
+            APP_ERROR_CHECK(err_code);
+
+            // Waits for the answer to be sent at the old rate.
+            err_code = uart_dma_reconfigure(mp_current->baudrate, hwfc_get(m_current_hwfc));
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case BAUD_STATE_REVERT_PENDING:
+            mp_current     = mp_previous;
+            m_current_hwfc = m_previous_hwfc;
+
+            err_code = uart_dma_reconfigure(mp_current->baudrate, hwfc_get(m_current_hwfc));
+            APP_ERROR_CHECK(err_code);
+
+            m_state = BAUD_STATE_IDLE;
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+uint32_t uart_baud_bps_get(void)
+{
+    return mp_current->bps;
+}
+
+
+bool uart_baud_hwfc_get(void)
+{
+    return m_current_hwfc;
+}
@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup uart_baud UART baud rate negotiation
+ * @{
+ * @brief Host-initiated switch to a higher baud rate, with fallback.
+ *
+ * @details The exchange uses @ref uart_frame frames. Request, acknowledge and
+ *          confirm frames carry the baud rate in bits/s (uint32, little-endian)
+ *          followed by a flags byte (@ref UART_BAUD_FLAG_HWFC).
+ *
+ *          1. The host sends @ref UART_BAUD_FRAME_REQUEST at the current rate.
+ *          2. The board answers with @ref UART_BAUD_FRAME_ACK, or with
+ *             @ref UART_BAUD_FRAME_NACK carrying the current settings if the
+ *             rate is not supported. After the answer has been sent the board
+ *             switches to the new settings.
+ *          3. The host switches as well and sends @ref UART_BAUD_FRAME_CONFIRM
+ *             at the new rate, which the board echoes. A confirmation that
+ *             arrives after the timeout, or without a pending switch, is
+ *             answered with @ref UART_BAUD_FRAME_NACK carrying the settings
+ *             the board runs at from then on.
+ *
+ *          If the confirmation has not arrived within
+ *          @ref UART_BAUD_CONFIRM_TIMEOUT_MS the board returns to the previous
+ *          settings, so a failed switch never leaves the link dead.
+ *
+ *          With flow control enabled the host must drive CTS, otherwise the
+ *          board cannot send.
+ */
+
+#ifndef UART_BAUD_H__
+#define UART_BAUD_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+#include "nrf_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_BAUD_CONFIRM_TIMEOUT_MS    1000    /**< Time the host has to confirm a new rate. */
+
+#define UART_BAUD_FRAME_REQUEST         0x10    /**< Host asks for new settings. */
+#define UART_BAUD_FRAME_ACK             0x11    /**< Board accepts and is about to switch. */
+#define UART_BAUD_FRAME_NACK            0x12    /**< Board rejects, carries the settings in force. */
+#define UART_BAUD_FRAME_CONFIRM         0x13    /**< Host confirms the link works at the new rate. */
+
+#define UART_BAUD_FLAG_HWFC             0x01    /**< RTS/CTS flow control enabled. */
+
+/**@brief Function for initializing the negotiation.
+ *
+ * @details Requires the application timer module to be initialized.
+ *
+ * @param[in] baudrate  Baud rate the UART has been initialized with.
+ * @param[in] hwfc      Flow control the UART has been initialized with.
+ *
+ * @retval NRF_SUCCESS  The negotiation is ready.
+ * @return Errors from @ref app_timer_create.
+ */
+ret_code_t uart_baud_init(nrf_uart_baudrate_t baudrate, nrf_uart_hwfc_t hwfc);
+
+/**@brief Function for handling a received frame.
+ *
+ * @return True if the frame belongs to the negotiation.
+ */
+bool uart_baud_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length);
+
+/**@brief Function for performing pending switches. Call from the main loop. */
+void uart_baud_process(void);
+
+/**@brief Function for getting the current baud rate in bits/s. */
+uint32_t uart_baud_bps_get(void);
+
+/**@brief Function for checking if flow control is enabled. */
+bool uart_baud_hwfc_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_BAUD_H__
+
+/** @} */
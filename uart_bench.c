@@ -0,0 +1,433 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "uart_bench.h"
+#include "uart_baud.h"
+#include "uart_dma.h"
+#include "uart_frame.h"
+#include "nrf.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "app_timer.h"
+#include "app_util.h"
+#include "nordic_common.h"
+#include "sdk_macros.h"
+
+// Line printed by the TX test. Free of SLIP special bytes.
+#define TX_LINE     "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\r\n"
+
+/**@brief Benchmark phase. */
+typedef enum
+{
+    BENCH_IDLE,
+    BENCH_ECHO,
+    BENCH_TX,
+    BENCH_RX_WAIT,  // Waiting for the host to start streaming.
+    BENCH_RX,
+} bench_phase_t;
+
+static const nrf_drv_timer_t m_timestamp = NRF_DRV_TIMER_INSTANCE(UART_BENCH_TIMESTAMP_TIMER);
+
+APP_TIMER_DEF(m_phase_timer_id);
+
+static uart_bench_print_t     m_print;
+static nrf_ppi_channel_t      m_ppi_tx_start;
+static nrf_ppi_channel_t      m_ppi_rx_byte;
+static volatile bench_phase_t m_phase;
+static uint32_t               m_duration_ms;
+
+// Current test.
+static uint32_t               m_bytes;
+static uint32_t               m_start_ticks;
+static uint32_t               m_rx_dropped;
+
+// Echo test.
+static uint32_t               m_echo_seq;
+static uint32_t               m_echo_lost;
+static uint32_t               m_rtt_min;
+static uint32_t               m_rtt_max;
+static uint32_t               m_rtt_sum;
+
+
+static void phase_timer_start(uint32_t timeout_ms)
+{
+    (void)app_timer_stop(m_phase_timer_id);
+    (void)app_timer_start(m_phase_timer_id, APP_TIMER_TICKS(MAX(timeout_ms, 1)), NULL);
+}
+
+
+static void measure_start(void)
+{
+    m_bytes       = 0;
+    m_start_ticks = app_timer_cnt_get();
+    DWT->CYCCNT   = 0;
+}
+
+
+/**@brief Function for ending a measurement.
+ *
+ * @param[out] p_ms             Elapsed time.
+ * @param[out] p_cpu_permille   CPU load in 1/1000.
+ */
+static void measure_stop(uint32_t * p_ms, uint32_t * p_cpu_permille)
+{
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t ticks  = MAX(app_timer_cnt_diff_compute(app_timer_cnt_get(), m_start_ticks), 1);
+
+    *p_ms           = (uint32_t)(((uint64_t)ticks * 1000) / APP_TIMER_TICKS(1000));
+    *p_cpu_permille = (uint32_t)MIN(1000, ((uint64_t)cycles * 1000 * APP_TIMER_TICKS(1000)) /
+                                          ((uint64_t)ticks * SystemCoreClock));
+}
+
+
+static uint32_t per_second(uint32_t count, uint32_t ms)
+{
+    return (uint32_t)(((uint64_t)count * 1000) / MAX(ms, 1));
+}
+
+
+static void json_send(uint8_t type, char const * p_fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void json_send(uint8_t type, char const * p_fmt, ...)
+{
+    va_list args;
+
+    // Formatted straight into the TX queue.
+    va_start(args, p_fmt);
+    (void)uart_frame_vprintf(type, p_fmt, &args);
+    va_end(args);
+}
+
+
+static void suite_done(void)
+{
+    m_phase = BENCH_IDLE;
+
+    json_send(UART_BENCH_FRAME_DONE, "{\"test\":\"done\",\"bps\":%" PRIu32 ",\"hwfc\":%u}",
+              uart_baud_bps_get(), uart_baud_hwfc_get() ? 1u : 0u);
+}
+
+
+static void rx_begin(void)
+{
+    uint8_t payload[sizeof(uint32_t)];
+    uart_dma_rx_stats_t stats;
+
+    uart_dma_rx_stats_get(&stats);
+    m_rx_dropped = stats.dropped_bytes;
+
+    m_phase = BENCH_RX_WAIT;
+    (void)uart_frame_send(UART_BENCH_FRAME_RX_REQUEST, payload, uint32_encode(m_duration_ms, payload));
+    phase_timer_start(UART_BENCH_RX_WAIT_MS);
+}
+
+
+static void rx_end(void)
+{
+    uint32_t            ms;
+    uint32_t            cpu;
+    uart_dma_rx_stats_t stats;
+
+    measure_stop(&ms, &cpu);
+    uart_dma_rx_stats_get(&stats);
+
+    if (m_phase == BENCH_RX_WAIT)
+    {
+        // The host never started streaming.
+        ms = 0;
+    }
+
+    json_send(UART_BENCH_FRAME_RESULT,
+              "{\"test\":\"rx\",\"ms\":%" PRIu32 ",\"bytes\":%" PRIu32 ",\"bytes_per_s\":%" PRIu32
+              ",\"dropped\":%" PRIu32 ",\"cpu_permille\":%" PRIu32 "}",
+              ms, m_bytes, per_second(m_bytes, ms), stats.dropped_bytes - m_rx_dropped, cpu);
+
+    suite_done();
+}
+
+
+static void tx_refill(void)
+{
+    while (uart_dma_tx_pending() < UART_DMA_TX_QUEUE_SIZE / 2)
+    {
+        m_print(TX_LINE, sizeof(TX_LINE) - 1);
+    }
+}
+
+
+static void tx_begin(void)
+{
+    m_phase = BENCH_TX;
+    measure_start();
+    phase_timer_start(m_duration_ms);
+    tx_refill();
+}
+
+
+static void tx_end(void)
+{
+    uint32_t ms;
+    uint32_t cpu;
+
+    measure_stop(&ms, &cpu);
+
+    json_send(UART_BENCH_FRAME_RESULT,
+              "{\"test\":\"tx\",\"ms\":%" PRIu32 ",\"bytes\":%" PRIu32 ",\"bytes_per_s\":%" PRIu32
+              ",\"cpu_permille\":%" PRIu32 "}",
+              ms, m_bytes, per_second(m_bytes, ms), cpu);
+
+    rx_begin();
+}
+
+
+static void echo_probe_send(void)
+{
+    phase_timer_start(UART_BENCH_ECHO_TIMEOUT_MS);
+    (void)uart_frame_printf(UART_BENCH_FRAME_ECHO, "echo %" PRIu32 "\n", m_echo_seq);
+}
+
+
+static void echo_next(void)
+{
+    uint32_t ms;
+    uint32_t cpu;
+    uint32_t received;
+
+    if (++m_echo_seq < UART_BENCH_ECHO_COUNT)
+    {
+        echo_probe_send();
+        return;
+    }
+
+    measure_stop(&ms, &cpu);
+    (void)nrf_drv_ppi_channel_disable(m_ppi_tx_start);
+    (void)nrf_drv_ppi_channel_disable(m_ppi_rx_byte);
+
+    received = UART_BENCH_ECHO_COUNT - m_echo_lost;
+    json_send(UART_BENCH_FRAME_RESULT,
+              "{\"test\":\"echo\",\"count\":%u,\"lost\":%" PRIu32 ",\"rtt_min_us\":%" PRIu32
+              ",\"rtt_avg_us\":%" PRIu32 ",\"rtt_max_us\":%" PRIu32 ",\"cpu_permille\":%" PRIu32 "}",
+              UART_BENCH_ECHO_COUNT, m_echo_lost, (received != 0) ? m_rtt_min : 0,
+              (received != 0) ? (m_rtt_sum / received) : 0, m_rtt_max, cpu);
+
+    tx_begin();
+}
+
+
+static void echo_begin(void)
+{
+    m_phase     = BENCH_ECHO;
+    m_echo_seq  = 0;
+    m_echo_lost = 0;
+    m_rtt_min   = UINT32_MAX;
+    m_rtt_max   = 0;
+    m_rtt_sum   = 0;
+
+    (void)nrf_drv_ppi_channel_enable(m_ppi_tx_start);
+    (void)nrf_drv_ppi_channel_enable(m_ppi_rx_byte);
+
+    measure_start();
+    echo_probe_send();
+}
+
+
+static void echo_received(uint8_t const * p_payload, size_t length)
+{
+    char     line[16];
+    int      len = snprintf(line, sizeof(line), "echo %" PRIu32 "\n", m_echo_seq);
+    uint32_t rtt;
+
+    if ((length != (size_t)len) || (memcmp(p_payload, line, length) != 0))
+    {
+        // Late echo of a probe that has already timed out.
+        return;
+    }
+
+    (void)app_timer_stop(m_phase_timer_id);
+
+    // From the start of the line to the last byte of its echo.
+    rtt = nrf_drv_timer_capture_get(&m_timestamp, NRF_TIMER_CC_CHANNEL1) -
+          nrf_drv_timer_capture_get(&m_timestamp, NRF_TIMER_CC_CHANNEL0);
+
+    m_rtt_min  = MIN(m_rtt_min, rtt);
+    m_rtt_max  = MAX(m_rtt_max, rtt);
+    m_rtt_sum += rtt;
+
+    echo_next();
+}
+
+
+static void phase_timeout_handler(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    switch (m_phase)
+    {
+        case BENCH_ECHO:
+            m_echo_lost++;
+            echo_next();
+            break;
+
+        case BENCH_TX:
+            tx_end();
+            break;
+
+        case BENCH_RX_WAIT:
+        case BENCH_RX:
+            rx_end();
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void timestamp_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    // No interrupts are enabled on the timestamp timer.
+}
+
+
+ret_code_t uart_bench_init(uart_bench_print_t print)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(print);
+
+    m_print = print;
+    m_phase = BENCH_IDLE;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    nrf_drv_timer_config_t timer_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_cfg.frequency = NRF_TIMER_FREQ_1MHz;
+    timer_cfg.mode      = NRF_TIMER_MODE_TIMER;
+    timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    err_code = nrf_drv_timer_init(&m_timestamp, &timer_cfg, timestamp_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return err_code;
+    }
+
+    // Timestamp the start of every transfer in CC0 and every received byte in CC1.
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_tx_start);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_tx_start,
+                                          (uint32_t)&NRF_UARTE0->EVENTS_TXSTARTED,
+                                          nrf_drv_timer_capture_task_address_get(&m_timestamp,
+                                                                                 NRF_TIMER_CC_CHANNEL0));
+    VERIFY_SUCCESS(err_code);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_rx_byte);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_rx_byte,
+                                          (uint32_t)&NRF_UARTE0->EVENTS_RXDRDY,
+                                          nrf_drv_timer_capture_task_address_get(&m_timestamp,
+                                                                                 NRF_TIMER_CC_CHANNEL1));
+    VERIFY_SUCCESS(err_code);
+
+    nrf_drv_timer_enable(&m_timestamp);
+
+    return app_timer_create(&m_phase_timer_id, APP_TIMER_MODE_SINGLE_SHOT, phase_timeout_handler);
+}
+
+
+bool uart_bench_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length)
+{
+    switch (type)
+    {
+        case UART_BENCH_FRAME_START:
+            if ((length == sizeof(uint32_t)) && (m_phase == BENCH_IDLE))
+            {
+                m_duration_ms = MIN(uint32_decode(p_payload), UART_BENCH_MAX_DURATION_MS);
+                echo_begin();
+            }
+            break;
+
+        case UART_BENCH_FRAME_ECHO:
+            if (m_phase == BENCH_ECHO)
+            {
+                echo_received(p_payload, length);
+            }
+            break;
+
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+
+void uart_bench_tx_done(size_t length)
+{
+    if (m_phase == BENCH_TX)
+    {
+        m_bytes += length;
+        tx_refill();
+    }
+}
+
+
+void uart_bench_rx_data(size_t length)
+{
+    if (m_phase == BENCH_RX_WAIT)
+    {
+        // The first chunk of the stream starts the measurement.
+        m_phase = BENCH_RX;
+        measure_start();
+        phase_timer_start(m_duration_ms);
+    }
+
+    if (m_phase == BENCH_RX)
+    {
+        m_bytes += length;
+    }
+}
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup uart_bench UART benchmark suite
+ * @{
+ * @brief Measures echo latency, TX and RX throughput and CPU load at the current UART settings.
+ *
+ * @details Built into the nrf52832_xxaa_bench target. The host selects a rate
+ *          with @ref uart_baud and sends @ref UART_BENCH_FRAME_START with the
+ *          run time per test in milliseconds (uint32, little-endian). The board
+ *          then runs the tests in order and reports each one as a JSON object in
+ *          a @ref UART_BENCH_FRAME_RESULT frame:
+ *
+ *          - echo: @ref UART_BENCH_ECHO_COUNT text lines are sent in
+ *            @ref UART_BENCH_FRAME_ECHO frames, which the host sends straight
+ *            back. The round trip is timed in hardware: PPI captures a free
+ *            running 1 MHz TIMER on UARTE TXSTARTED and on every RXDRDY, so it
+ *            runs from the start of the line to the last byte of the echo.
+ *          - tx: the TX queue is kept half full through the application's print
+ *            function, refilled on every @ref UART_DMA_EVT_TX_DONE.
+ *          - rx: the board sends @ref UART_BENCH_FRAME_RX_REQUEST with the run
+ *            time and counts the bytes the host streams, from the first chunk
+ *            on. The stream must not contain SLIP END bytes.
+ *
+ *          A @ref UART_BENCH_FRAME_DONE frame with the rate closes the suite.
+ *
+ *          CPU load is the number of DWT cycles counted during a test divided by
+ *          the cycles available. The cycle counter stops while the CPU sleeps, so
+ *          the measurement is only valid with no debugger attached.
+ */
+
+#ifndef UART_BENCH_H__
+#define UART_BENCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_BENCH_TIMESTAMP_TIMER  4       /**< TIMER instance used for the echo timestamps. */
+#define UART_BENCH_ECHO_COUNT       32      /**< Number of echo round trips. */
+#define UART_BENCH_ECHO_TIMEOUT_MS  100     /**< Time after which an echo is counted as lost. */
+#define UART_BENCH_RX_WAIT_MS       1000    /**< Time the host has to start streaming. */
+#define UART_BENCH_MAX_DURATION_MS  60000   /**< Longest test. The 32-bit cycle counter wraps after 67 s at 64 MHz. */
+
+#define UART_BENCH_FRAME_START      0x20    /**< Host starts the suite. */
+#define UART_BENCH_FRAME_RESULT     0x21    /**< Board reports a test result, JSON text. */
+#define UART_BENCH_FRAME_ECHO       0x22    /**< Echo line, sent back unchanged by the host. */
+#define UART_BENCH_FRAME_RX_REQUEST 0x23    /**< Board asks the host to stream data. */
+#define UART_BENCH_FRAME_DONE       0x24    /**< Board has finished the suite, JSON text. */
+
+/**@brief Function for printing a message on the UART, as used by the application. */
+typedef void (* uart_bench_print_t)(char const * p_data, size_t length);
+
+/**@brief Function for initializing the benchmark.
+ *
+ * @details Requires the application timer module to be initialized.
+ *
+ * @param[in] print     Print function exercised by the TX test.
+ *
+ * @retval NRF_SUCCESS  The benchmark is ready.
+ * @return Errors from the TIMER, PPI and application timer modules.
+ */
+ret_code_t uart_bench_init(uart_bench_print_t print);
+
+/**@brief Function for handling a received frame.
+ *
+ * @return True if the frame belongs to the benchmark.
+ */
+bool uart_bench_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length);
+
+/**@brief Function for handling @ref UART_DMA_EVT_TX_DONE.
+ *
+ * @param[in] length    Number of bytes sent.
+ */
+void uart_bench_tx_done(size_t length);
+
+/**@brief Function for handling @ref UART_DMA_EVT_RX_DATA.
+ *
+ * @param[in] length    Number of bytes received.
+ */
+void uart_bench_rx_data(size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_BENCH_H__
+
+/** @} */
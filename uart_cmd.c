@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "uart_cmd.h"
+#include "uart_frame.h"
+#include "app_util.h"
+#include "nordic_common.h"
+#include "sdk_macros.h"
+
+STATIC_ASSERT(IS_POWER_OF_TWO(UART_CMD_INDEX_SIZE));
+STATIC_ASSERT(UART_CMD_INDEX_SIZE <= UINT8_MAX);
+
+#define INDEX_MASK      (UART_CMD_INDEX_SIZE - 1)
+#define INDEX_EMPTY     0xFF
+#define SEED_ATTEMPTS   256
+
+static uart_cmd_t const * mp_cmds;
+static uint8_t            m_index[UART_CMD_INDEX_SIZE];    // Position in mp_cmds, or INDEX_EMPTY.
+static uint32_t           m_seed;
+
+
+/**@brief Function for computing the seeded FNV-1a hash of a name. */
+static uint32_t name_hash(char const * p_name, uint32_t seed)
+{
+    uint32_t hash = 2166136261UL ^ seed;
+
+    while (*p_name != '\0')
+    {
+        hash ^= (uint8_t)*p_name++;
+        hash *= 16777619UL;
+    }
+
+    return (hash ^ (hash >> 16)) & INDEX_MASK;
+}
+
+
+static bool index_build(size_t count, uint32_t seed)
+{
+    memset(m_index, INDEX_EMPTY, sizeof(m_index));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t slot = name_hash(mp_cmds[i].p_name, seed);
+
+        if (m_index[slot] != INDEX_EMPTY)
+        {
+            return false;
+        }
+        m_index[slot] = (uint8_t)i;
+    }
+
+    return true;
+}
+
+
+static void response_send(ret_code_t result)
+{
+    uint8_t payload[sizeof(uint32_t)];
+
+    (void)uart_frame_send(UART_CMD_FRAME_RESPONSE, payload, uint32_encode(result, payload));
+}
+
+
+static ret_code_t dispatch(char * p_line)
+{
+    char     * argv[UART_CMD_MAX_ARGS];
+    size_t     argc = 0;
+    uint8_t    pos;
+
+    // Split the line in place.
+    while (*p_line != '\0')
+    {
+        if (*p_line == ' ')
+        {
+            *p_line++ = '\0';
+            continue;
+        }
+
+        if (argc == UART_CMD_MAX_ARGS)
+        {
+            return NRF_ERROR_INVALID_LENGTH;
+        }
+        argv[argc++] = p_line;
+
+        while ((*p_line != '\0') && (*p_line != ' '))
+        {
+            p_line++;
+        }
+    }
+
+    if ((argc == 0) || (mp_cmds == NULL))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    pos = m_index[name_hash(argv[0], m_seed)];
+    if ((pos == INDEX_EMPTY) || (strcmp(mp_cmds[pos].p_name, argv[0]) != 0))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    return mp_cmds[pos].handler(argc - 1, &argv[1]);
+}
+
+
+ret_code_t uart_cmd_init(uart_cmd_t const * p_cmds, size_t count)
+{
+    VERIFY_PARAM_NOT_NULL(p_cmds);
+
+    if (count > UART_CMD_MAX_COUNT)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    mp_cmds = p_cmds;
+
+    for (m_seed = 0; m_seed < SEED_ATTEMPTS; m_seed++)
+    {
+        if (index_build(count, m_seed))
+        {
+            return NRF_SUCCESS;
+        }
+    }
+
+    return NRF_ERROR_INVALID_PARAM;
+}
+
+
+bool uart_cmd_frame_handler(uint8_t type, uint8_t const * p_payload, size_t length)
+{
+    char line[UART_FRAME_MAX_PAYLOAD + 1];
+
+    if (type != UART_CMD_FRAME_REQUEST)
+    {
+        return false;
+    }
+
+    // Terminate the line, trailing line breaks are ignored.
+    memcpy(line, p_payload, length);
+    line[length] = '\0';
+    while ((length > 0) && ((line[length - 1] == '\r') || (line[length - 1] == '\n')))
+    {
+        line[--length] = '\0';
+    }
+
+    response_send(dispatch(line));
+
+    return true;
+}
+
+
+ret_code_t uart_cmd_arg_u32(char const * p_arg, uint32_t * p_value)
+{
+    char * p_end;
+
+    *p_value = strtoul(p_arg, &p_end, 0);
+
+    return ((*p_arg != '\0') && (*p_end == '\0')) ? NRF_SUCCESS : NRF_ERROR_INVALID_PARAM;
+}
+
+
+ret_code_t uart_cmd_arg_i32(char const * p_arg, int32_t * p_value)
+{
+    char * p_end;
+
+    *p_value = strtol(p_arg, &p_end, 0);
+
+    return ((*p_arg != '\0') && (*p_end == '\0')) ? NRF_SUCCESS : NRF_ERROR_INVALID_PARAM;
+}
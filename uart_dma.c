@@ -0,0 +1,916 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <string.h>
+
+#include "uart_dma.h"
+#include "nrf_drv_uart.h"
+#include "nrf_drv_timer.h"
+#include "nrf_drv_ppi.h"
+#include "app_util_platform.h"
+#include "app_error.h"
+#include "app_timer.h"
+#include "nrf_fprintf.h"
+#include "nrf_fprintf_format.h"
+#include "sdk_macros.h"
+
+STATIC_ASSERT(IS_POWER_OF_TWO(UART_DMA_TX_QUEUE_SIZE));
+STATIC_ASSERT(IS_POWER_OF_TWO(UART_DMA_TX_DESC_COUNT));
+STATIC_ASSERT(UART_DMA_RX_BUF_SIZE <= UART_DMA_TX_BUF_SIZE);
+
+#define TX_QUEUE_MASK   (UART_DMA_TX_QUEUE_SIZE - 1)
+#define TX_DESC_MASK    (UART_DMA_TX_DESC_COUNT - 1)
+#define RX_SCRATCH      UART_DMA_RX_POOL_SIZE   // Index of the buffer used when the pool is exhausted.
+
+/**@brief TX queue entry. */
+typedef struct
+{
+    uint8_t const * p_data;     // Held RX data sent by reference, NULL for bytes copied into the TX queue,
+                                // or TX_DESC_RESERVED for copied bytes that are still being written.
+    uint32_t        length;
+} tx_desc_t;
+
+/**@brief Kind of a write to the TX queue. */
+typedef enum
+{
+    TX_COPY,        // Copied into the TX queue.
+    TX_HELD,        // Held RX data, sent by reference.
+    TX_RESERVE,     // Space in the TX queue, filled by the caller and sent when committed.
+} tx_kind_t;
+
+// Marks the entry of a reservation that has not been committed. It is neither sent nor dropped.
+#define TX_DESC_RESERVED    ((uint8_t const *)m_tx_queue)
+
+// UARTE instance. EasyDMA is selected by UART0_CONFIG_USE_EASY_DMA in sdk_config.h.
+static const nrf_drv_uart_t  m_uart        = NRF_DRV_UART_INSTANCE(0);
+static const nrf_drv_timer_t m_rx_counter  = NRF_DRV_TIMER_INSTANCE(UART_DMA_RX_COUNTER_TIMER);
+static const nrf_drv_timer_t m_rx_idle     = NRF_DRV_TIMER_INSTANCE(UART_DMA_RX_IDLE_TIMER);
+
+static uart_dma_evt_handler_t m_evt_handler;
+static nrf_drv_uart_config_t  m_drv_config;     // Kept for reconfiguration.
+
+// TX queue. Copied data is stored in m_tx_queue, and m_tx_desc keeps the order between copied data and
+// data sent by reference. All indexes run freely and are masked when indexing.
+static uint8_t                m_tx_queue[UART_DMA_TX_QUEUE_SIZE];
+static uint32_t               m_tx_rd;
+static uint32_t               m_tx_wr;
+static tx_desc_t              m_tx_desc[UART_DMA_TX_DESC_COUNT];
+static uint32_t               m_tx_desc_rd;
+static uint32_t               m_tx_desc_wr;
+static uart_dma_tx_overflow_t m_tx_overflow;
+static uint32_t               m_tx_block_ticks;
+static uart_dma_tx_stats_t    m_tx_stats;
+
+// Data owned by EasyDMA while m_tx_busy is set: either a chunk copied from the TX queue into m_tx_buf,
+// or held RX data (mp_tx_held) that is released when it has been sent.
+static uint8_t                m_tx_buf[UART_DMA_TX_BUF_SIZE];
+static uint8_t const *        mp_tx_held;
+static volatile bool          m_tx_busy;
+
+// RX buffer pool. A buffer is free when its reference count is zero. EasyDMA holds one reference
+// while it writes to the buffer, and the application holds one for every piece of data it keeps.
+static uint8_t          m_rx_pool[UART_DMA_RX_POOL_SIZE + 1][UART_DMA_RX_BUF_SIZE];
+static uint8_t          m_rx_refcnt[UART_DMA_RX_POOL_SIZE];
+static uart_dma_rx_stats_t m_rx_stats;
+
+// RX DMA slots. Byte positions are counted from the start of reception, so slot i holds
+// the bytes [m_rx_start[i], m_rx_start[i] + UART_DMA_RX_BUF_SIZE) in pool buffer m_rx_slot[i].
+static uint8_t          m_rx_slot[2];
+static uint32_t         m_rx_start[2];
+static uint8_t          m_rx_primary;           // Slot EasyDMA is currently writing to.
+static uint32_t         m_rx_consumed;          // Position of the first byte not yet delivered.
+static volatile bool    m_rx_stopped;           // Reception is being torn down, the RX state belongs to uart_dma_reconfigure().
+
+static nrf_ppi_channel_t m_ppi_rx_count;
+static nrf_ppi_channel_t m_ppi_rx_idle_start;
+
+
+/**@brief Function for converting a BAUDRATE register value to bits per second.
+ *
+ * @details The register value is the baud rate scaled by 2^32 / 16 MHz.
+ */
+static uint32_t baudrate_to_bps(nrf_uart_baudrate_t baudrate)
+{
+    return (uint32_t)(((uint64_t)baudrate * 16000000UL) >> 32);
+}
+
+
+static uint8_t rx_buf_idx(uint8_t const * p_data)
+{
+    return (uint8_t)((p_data - &m_rx_pool[0][0]) / UART_DMA_RX_BUF_SIZE);
+}
+
+
+static void rx_buf_unref(uint8_t idx)
+{
+    if ((idx != RX_SCRATCH) && (m_rx_refcnt[idx] != 0))
+    {
+        m_rx_refcnt[idx]--;
+    }
+}
+
+
+/**@brief Function for taking a free buffer from the pool.
+ *
+ * @return Index of the buffer, or RX_SCRATCH if all buffers are held.
+ */
+static uint8_t rx_buf_alloc(void)
+{
+    for (uint8_t i = 0; i < UART_DMA_RX_POOL_SIZE; i++)
+    {
+        if (m_rx_refcnt[i] == 0)
+        {
+            m_rx_refcnt[i] = 1;
+            return i;
+        }
+    }
+
+    return RX_SCRATCH;
+}
+
+
+/**@brief Function for starting the next transfer if the UARTE is idle.
+ *
+ * @details Must be called from the UARTE interrupt or with interrupts disabled.
+ */
+static void tx_kick(void)
+{
+    ret_code_t      err_code;
+    tx_desc_t     * p_desc;
+    uint8_t const * p_data;
+    uint32_t        length;
+
+    if (m_tx_busy || (m_tx_desc_rd == m_tx_desc_wr))
+    {
+        return;
+    }
+
+    p_desc = &m_tx_desc[m_tx_desc_rd & TX_DESC_MASK];
+
+    if (p_desc->p_data == TX_DESC_RESERVED)
+    {
+        // Started again by uart_dma_tx_commit().
+        return;
+    }
+
+    if (p_desc->p_data == NULL)
+    {
+        // Copied data. EasyDMA cannot wrap, so the chunk is gathered into m_tx_buf.
+        uint32_t offset = m_tx_rd & TX_QUEUE_MASK;
+        uint32_t first;
+
+        length = MIN(p_desc->length, UART_DMA_TX_BUF_SIZE);
+        first  = MIN(length, UART_DMA_TX_QUEUE_SIZE - offset);
+
+        memcpy(m_tx_buf, &m_tx_queue[offset], first);
+        memcpy(&m_tx_buf[first], m_tx_queue, length - first);
+        m_tx_rd += length;
+        p_data   = m_tx_buf;
+    }
+    else
+    {
+        // Held RX data goes straight from the RX buffer to the wire.
+        length     = p_desc->length;
+        p_data     = p_desc->p_data;
+        mp_tx_held = p_data;
+    }
+
+    p_desc->length -= length;
+    if (p_desc->length == 0)
+    {
+        m_tx_desc_rd++;
+    }
+
+    m_tx_busy = true;
+
+    err_code = nrf_drv_uart_tx(&m_uart, p_data, (uint8_t)length);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for checking if a write fits in the TX queue. */
+static bool tx_fits(size_t length, tx_kind_t kind)
+{
+    uint32_t  descs  = m_tx_desc_wr - m_tx_desc_rd;
+    tx_desc_t * p_last = &m_tx_desc[(m_tx_desc_wr - 1) & TX_DESC_MASK];
+
+    // Copied data is appended to the last entry if that holds copied data as well.
+    bool merge = (kind == TX_COPY) && (descs != 0) && (p_last->p_data == NULL);
+
+    if (!merge && (descs == UART_DMA_TX_DESC_COUNT))
+    {
+        return false;
+    }
+
+    return (kind == TX_HELD) || (length <= UART_DMA_TX_QUEUE_SIZE - (m_tx_wr - m_tx_rd));
+}
+
+
+static void tx_write(uart_dma_tx_seg_t const * p_segs, size_t count, size_t length, tx_kind_t kind)
+{
+    tx_desc_t * p_last = &m_tx_desc[(m_tx_desc_wr - 1) & TX_DESC_MASK];
+
+    if (kind == TX_HELD)
+    {
+        m_tx_desc[m_tx_desc_wr & TX_DESC_MASK] = (tx_desc_t){ .p_data = p_segs[0].p_data, .length = length };
+        m_tx_desc_wr++;
+        return;
+    }
+
+    if (kind == TX_RESERVE)
+    {
+        m_tx_desc[m_tx_desc_wr & TX_DESC_MASK] = (tx_desc_t){ .p_data = TX_DESC_RESERVED, .length = length };
+        m_tx_desc_wr++;
+        m_tx_wr += length;
+        m_tx_stats.high_water_mark = MAX(m_tx_stats.high_water_mark, m_tx_wr - m_tx_rd);
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t const * p_data = p_segs[i].p_data;
+        uint32_t        offset = m_tx_wr & TX_QUEUE_MASK;
+        uint32_t        first  = MIN(p_segs[i].length, UART_DMA_TX_QUEUE_SIZE - offset);
+
+        memcpy(&m_tx_queue[offset], p_data, first);
+        memcpy(m_tx_queue, &p_data[first], p_segs[i].length - first);
+        m_tx_wr += p_segs[i].length;
+    }
+
+    if ((m_tx_desc_wr != m_tx_desc_rd) && (p_last->p_data == NULL))
+    {
+        p_last->length += length;
+    }
+    else
+    {
+        m_tx_desc[m_tx_desc_wr & TX_DESC_MASK] = (tx_desc_t){ .p_data = NULL, .length = length };
+        m_tx_desc_wr++;
+    }
+
+    m_tx_stats.high_water_mark = MAX(m_tx_stats.high_water_mark, m_tx_wr - m_tx_rd);
+}
+
+
+/**@brief Function for discarding the oldest queued data until a write fits, or a reservation is reached. */
+static void tx_drop_oldest(size_t length, tx_kind_t kind)
+{
+    while (!tx_fits(length, kind) && (m_tx_desc_rd != m_tx_desc_wr) &&
+           (m_tx_desc[m_tx_desc_rd & TX_DESC_MASK].p_data != TX_DESC_RESERVED))
+    {
+        tx_desc_t * p_desc = &m_tx_desc[m_tx_desc_rd & TX_DESC_MASK];
+        uint32_t    count  = p_desc->length;
+
+        if (p_desc->p_data == NULL)
+        {
+            // Only drop as much copied data as is needed to make room.
+            uint32_t free = UART_DMA_TX_QUEUE_SIZE - (m_tx_wr - m_tx_rd);
+
+            if ((kind != TX_HELD) && (free < length))
+            {
+                count = MIN(count, length - free);
+            }
+            m_tx_rd += count;
+        }
+        else
+        {
+            rx_buf_unref(rx_buf_idx(p_desc->p_data));
+        }
+
+        p_desc->length -= count;
+        if (p_desc->length == 0)
+        {
+            m_tx_desc_rd++;
+        }
+        m_tx_stats.dropped_bytes += count;
+    }
+
+    m_tx_stats.dropped_writes++;
+}
+
+
+/**@brief Function for queuing copied or held data, or reserving space, according to the overflow policy.
+ *
+ * @details Copied data may be gathered from several segments, which are queued as one write.
+ *          Held data is always a single segment, and so is a reservation, whose p_data is not used.
+ *          The position of a reservation is returned in @p p_resv.
+ */
+static ret_code_t tx_enqueue(uart_dma_tx_seg_t const * p_segs, size_t count, tx_kind_t kind,
+                             uart_dma_tx_resv_t * p_resv)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+    bool       done     = false;
+    size_t     length   = 0;
+    bool       may_block;
+    uint32_t   start_ticks;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        length += p_segs[i].length;
+    }
+
+    if ((length == 0) || (length > UART_DMA_TX_QUEUE_SIZE))
+    {
+        if (kind == TX_HELD)
+        {
+            rx_buf_unref(rx_buf_idx(p_segs[0].p_data));
+        }
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    if (m_evt_handler == NULL)
+    {
+        // Not initialized yet.
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // Never sleep in interrupt context, the UARTE interrupt may not be able to preempt us.
+    may_block   = (m_tx_overflow == UART_DMA_TX_OVERFLOW_BLOCK) && (__get_IPSR() == 0);
+    start_ticks = may_block ? app_timer_cnt_get() : 0;
+
+    while (!done)
+    {
+        CRITICAL_REGION_ENTER();
+
+        if (!tx_fits(length, kind) && (m_tx_overflow == UART_DMA_TX_OVERFLOW_DROP_OLDEST))
+        {
+            tx_drop_oldest(length, kind);
+        }
+
+        if (tx_fits(length, kind))
+        {
+            if (kind == TX_RESERVE)
+            {
+                p_resv->wr   = m_tx_wr;
+                p_resv->left = length;
+                p_resv->desc = m_tx_desc_wr;
+            }
+            tx_write(p_segs, count, length, kind);
+            tx_kick();
+            done = true;
+        }
+        else if (!may_block ||
+                 (app_timer_cnt_diff_compute(app_timer_cnt_get(), start_ticks) >= m_tx_block_ticks))
+        {
+            if (kind == TX_HELD)
+            {
+                rx_buf_unref(rx_buf_idx(p_segs[0].p_data));
+            }
+            m_tx_stats.dropped_bytes += length;
+            m_tx_stats.dropped_writes++;
+            err_code = NRF_ERROR_NO_MEM;
+            done     = true;
+        }
+
+        CRITICAL_REGION_EXIT();
+
+        if (!done)
+        {
+            // Sleep until the UARTE interrupt has drained a chunk.
+            __WFE();
+        }
+    }
+
+    return err_code;
+}
+
+
+/**@brief Function for delivering all bytes received before position @p limit. */
+static void rx_deliver(uint32_t limit)
+{
+    while ((int32_t)(limit - m_rx_consumed) > 0)
+    {
+        uint8_t  slot   = ((m_rx_consumed - m_rx_start[m_rx_primary]) < UART_DMA_RX_BUF_SIZE) ?
+                          m_rx_primary : (m_rx_primary ^ 1);
+        uint8_t  idx    = m_rx_slot[slot];
+        uint32_t offset = m_rx_consumed - m_rx_start[slot];
+        uint32_t length = MIN(limit - m_rx_consumed, UART_DMA_RX_BUF_SIZE - offset);
+
+        m_rx_consumed += length;
+
+        if (idx == RX_SCRATCH)
+        {
+            // Received while every pool buffer was held by the application.
+            m_rx_stats.dropped_bytes += length;
+            continue;
+        }
+
+        uart_dma_evt_t evt;
+        evt.type             = UART_DMA_EVT_RX_DATA;
+        evt.data.rxtx.p_data = &m_rx_pool[idx][offset];
+        evt.data.rxtx.length = length;
+
+        m_evt_handler(&evt);
+    }
+}
+
+
+static void rx_start(void)
+{
+    nrf_drv_timer_clear(&m_rx_counter);
+
+    // Drop the references EasyDMA held on the previous buffers.
+    rx_buf_unref(m_rx_slot[0]);
+    rx_buf_unref(m_rx_slot[1]);
+
+    m_rx_slot[0]  = rx_buf_alloc();
+    m_rx_slot[1]  = rx_buf_alloc();
+    m_rx_primary  = 0;
+    m_rx_consumed = 0;
+    m_rx_start[0] = 0;
+    m_rx_start[1] = UART_DMA_RX_BUF_SIZE;
+
+    // The first call starts reception, the second one provides the secondary buffer.
+    (void)nrf_drv_uart_rx(&m_uart, m_rx_pool[m_rx_slot[0]], UART_DMA_RX_BUF_SIZE);
+    (void)nrf_drv_uart_rx(&m_uart, m_rx_pool[m_rx_slot[1]], UART_DMA_RX_BUF_SIZE);
+}
+
+
+static void uart_drv_event_handler(nrf_drv_uart_event_t * p_event, void * p_context)
+{
+    uart_dma_evt_t evt;
+
+    switch (p_event->type)
+    {
+        case NRF_DRV_UART_EVT_TX_DONE:
+            evt.type              = UART_DMA_EVT_TX_DONE;
+            evt.data.rxtx.p_data  = p_event->data.rxtx.p_data;
+            evt.data.rxtx.length  = p_event->data.rxtx.bytes;
+
+            if (mp_tx_held != NULL)
+            {
+                rx_buf_unref(rx_buf_idx(mp_tx_held));
+                mp_tx_held = NULL;
+            }
+
+            m_tx_busy = false;
+            tx_kick();
+
+            m_evt_handler(&evt);
+            break;
+
+        case NRF_DRV_UART_EVT_RX_DONE:
+        {
+            // The primary buffer is full and EasyDMA has moved on to the secondary one.
+            uint8_t full = m_rx_primary;
+
+            if (m_rx_stopped)
+            {
+                // Ended by the abort in uart_dma_reconfigure(), not by a full buffer.
+                break;
+            }
+
+            rx_deliver(m_rx_start[full] + UART_DMA_RX_BUF_SIZE);
+
+            // EasyDMA is done with the buffer. Queue a free one as the next secondary buffer; the
+            // full one returns to the pool once the application has released it.
+            rx_buf_unref(m_rx_slot[full]);
+            m_rx_slot[full]  = rx_buf_alloc();
+            m_rx_primary     = full ^ 1;
+            m_rx_start[full] = m_rx_start[m_rx_primary] + UART_DMA_RX_BUF_SIZE;
+            (void)nrf_drv_uart_rx(&m_uart, m_rx_pool[m_rx_slot[full]], UART_DMA_RX_BUF_SIZE);
+            break;
+        }
+
+        case NRF_DRV_UART_EVT_ERROR:
+            evt.type            = UART_DMA_EVT_ERROR;
+            evt.data.error_mask = p_event->data.error.error_mask;
+            m_evt_handler(&evt);
+
+            // The driver aborts reception on error.
+            if (!m_rx_stopped)
+            {
+                rx_start();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+static void rx_counter_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    // No interrupts are enabled on the counter.
+}
+
+
+static void rx_idle_event_handler(nrf_timer_event_t event_type, void * p_context)
+{
+    if ((event_type == NRF_TIMER_EVENT_COMPARE0) && !m_rx_stopped)
+    {
+        // The line has been idle long enough for the last byte to have reached RAM.
+        rx_deliver(nrf_drv_timer_capture(&m_rx_counter, NRF_TIMER_CC_CHANNEL0));
+    }
+}
+
+
+/**@brief Function for setting the idle gap that ends an RX chunk for the given baud rate. */
+static void rx_idle_timeout_set(nrf_uart_baudrate_t baudrate)
+{
+    // Stop the idle timer when the gap has elapsed. It is restarted by the next received byte.
+    uint32_t idle_us = CEIL_DIV(UART_DMA_RX_IDLE_BITS * 1000000UL, baudrate_to_bps(baudrate));
+    nrf_drv_timer_extended_compare(&m_rx_idle,
+                                   NRF_TIMER_CC_CHANNEL0,
+                                   nrf_drv_timer_us_to_ticks(&m_rx_idle, idle_us),
+                                   NRF_TIMER_SHORT_COMPARE0_STOP_MASK,
+                                   true);
+}
+
+
+static ret_code_t rx_idle_detection_init(uart_dma_config_t const * p_config)
+{
+    ret_code_t err_code;
+    uint32_t   rxdrdy = nrf_drv_uart_event_address_get(&m_uart, NRF_UART_EVENT_RXDRDY);
+
+    nrf_drv_timer_config_t counter_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    counter_cfg.mode      = NRF_TIMER_MODE_COUNTER;
+    counter_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    err_code = nrf_drv_timer_init(&m_rx_counter, &counter_cfg, rx_counter_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    nrf_drv_timer_config_t idle_cfg = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    idle_cfg.frequency          = NRF_TIMER_FREQ_1MHz;
+    idle_cfg.mode               = NRF_TIMER_MODE_TIMER;
+    idle_cfg.bit_width          = NRF_TIMER_BIT_WIDTH_32;
+    idle_cfg.interrupt_priority = p_config->irq_priority;
+
+    err_code = nrf_drv_timer_init(&m_rx_idle, &idle_cfg, rx_idle_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    rx_idle_timeout_set(p_config->baudrate);
+
+    err_code = nrf_drv_ppi_init();
+    if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_MODULE_ALREADY_INITIALIZED))
+    {
+        return err_code;
+    }
+
+    // RXDRDY counts the byte and clears the idle timer ...
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_rx_count);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_rx_count,
+                                          rxdrdy,
+                                          nrf_drv_timer_task_address_get(&m_rx_counter, NRF_TIMER_TASK_COUNT));
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_rx_count,
+                                               nrf_drv_timer_task_address_get(&m_rx_idle, NRF_TIMER_TASK_CLEAR));
+    VERIFY_SUCCESS(err_code);
+
+    // ... and (re)starts it.
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_rx_idle_start);
+    VERIFY_SUCCESS(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_rx_idle_start,
+                                          rxdrdy,
+                                          nrf_drv_timer_task_address_get(&m_rx_idle, NRF_TIMER_TASK_START));
+    VERIFY_SUCCESS(err_code);
+
+    // The counter runs all the time; the idle timer is only started by incoming data.
+    nrf_drv_timer_enable(&m_rx_counter);
+
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_rx_count);
+    VERIFY_SUCCESS(err_code);
+
+    return nrf_drv_ppi_channel_enable(m_ppi_rx_idle_start);
+}
+
+
+ret_code_t uart_dma_init(uart_dma_config_t const * p_config, uart_dma_evt_handler_t evt_handler)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(p_config);
+    VERIFY_PARAM_NOT_NULL(evt_handler);
+
+    nrf_drv_uart_config_t config = NRF_DRV_UART_DEFAULT_CONFIG;
+    config.pselrxd            = p_config->rx_pin;
+    config.pseltxd            = p_config->tx_pin;
+    config.pselrts            = p_config->rts_pin;
+    config.pselcts            = p_config->cts_pin;
+    config.hwfc               = p_config->hwfc;
+    config.baudrate           = p_config->baudrate;
+    config.interrupt_priority = p_config->irq_priority;
+    config.use_easy_dma       = true;
+    m_drv_config              = config;
+
+    m_evt_handler    = evt_handler;
+    m_tx_rd          = 0;
+    m_tx_wr          = 0;
+    m_tx_desc_rd     = 0;
+    m_tx_desc_wr     = 0;
+    mp_tx_held       = NULL;
+    m_tx_busy        = false;
+    m_rx_slot[0]     = RX_SCRATCH;
+    m_rx_slot[1]     = RX_SCRATCH;
+    m_rx_stopped     = false;
+    m_tx_overflow    = p_config->tx_overflow;
+    m_tx_block_ticks = APP_TIMER_TICKS(p_config->tx_block_timeout_ms);
+    memset(&m_tx_stats, 0, sizeof(m_tx_stats));
+    memset(&m_rx_stats, 0, sizeof(m_rx_stats));
+    memset(m_rx_refcnt, 0, sizeof(m_rx_refcnt));
+
+    err_code = nrf_drv_uart_init(&m_uart, &config, uart_drv_event_handler);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = rx_idle_detection_init(p_config);
+    VERIFY_SUCCESS(err_code);
+
+    rx_start();
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t uart_dma_reconfigure(nrf_uart_baudrate_t baudrate, nrf_uart_hwfc_t hwfc)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+    uint32_t   limit;
+    bool       idle;
+
+    if (__get_IPSR() != 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // Stop reception. The RX events are ignored from here on, so the RX state
+    // is only touched by this function.
+    CRITICAL_REGION_ENTER();
+    m_rx_stopped = true;
+    nrf_drv_timer_pause(&m_rx_idle);
+    nrf_drv_timer_clear(&m_rx_idle);
+    nrf_drv_uart_rx_abort(&m_uart);
+    limit = nrf_drv_timer_capture(&m_rx_counter, NRF_TIMER_CC_CHANNEL0);
+    CRITICAL_REGION_EXIT();
+
+    // Hand over what has been received so far with interrupts enabled: the
+    // handler may transmit and wait for room in the queue. The rest of the RX
+    // buffers is discarded.
+    rx_deliver(limit);
+
+    do
+    {
+        // Let everything queued go out at the old rate.
+        while (uart_dma_tx_busy())
+        {
+            __WFE();
+        }
+
+        // An interrupt may have queued more since, it is sent before the switch.
+        CRITICAL_REGION_ENTER();
+        idle = !uart_dma_tx_busy();
+        if (idle)
+        {
+            nrf_drv_uart_uninit(&m_uart);
+
+            m_drv_config.baudrate = baudrate;
+            m_drv_config.hwfc     = hwfc;
+
+            err_code = nrf_drv_uart_init(&m_uart, &m_drv_config, uart_drv_event_handler);
+            if (err_code == NRF_SUCCESS)
+            {
+                m_rx_stopped = false;
+                rx_idle_timeout_set(baudrate);
+                rx_start();
+            }
+        }
+        CRITICAL_REGION_EXIT();
+    } while (!idle);
+
+    return err_code;
+}
+
+
+ret_code_t uart_dma_tx(uint8_t const * p_data, size_t length)
+{
+    uart_dma_tx_seg_t const seg = { .p_data = p_data, .length = length };
+
+    return tx_enqueue(&seg, 1, TX_COPY, NULL);
+}
+
+
+ret_code_t uart_dma_tx_gather(uart_dma_tx_seg_t const * p_segs, size_t count)
+{
+    return tx_enqueue(p_segs, count, TX_COPY, NULL);
+}
+
+
+ret_code_t uart_dma_tx_reserve(size_t length, uart_dma_tx_resv_t * p_resv)
+{
+    uart_dma_tx_seg_t const seg = { .p_data = NULL, .length = length };
+
+    VERIFY_PARAM_NOT_NULL(p_resv);
+
+    return tx_enqueue(&seg, 1, TX_RESERVE, p_resv);
+}
+
+
+void uart_dma_tx_resv_write(uart_dma_tx_resv_t * p_resv, void const * p_data, size_t length)
+{
+    uint8_t const * p_src  = p_data;
+    uint32_t        offset = p_resv->wr & TX_QUEUE_MASK;
+    uint32_t        first;
+
+    // The reserved space is owned by the caller, no other context touches it.
+    length = MIN(length, p_resv->left);
+    first  = MIN(length, UART_DMA_TX_QUEUE_SIZE - offset);
+
+    memcpy(&m_tx_queue[offset], p_src, first);
+    memcpy(m_tx_queue, &p_src[first], length - first);
+    p_resv->wr   += length;
+    p_resv->left -= length;
+}
+
+
+void uart_dma_tx_commit(uart_dma_tx_resv_t * p_resv)
+{
+    // Later writes are queued behind the reservation, so unused space cannot be returned.
+    while (p_resv->left != 0)
+    {
+        uint32_t offset = p_resv->wr & TX_QUEUE_MASK;
+        uint32_t n      = MIN(p_resv->left, UART_DMA_TX_QUEUE_SIZE - offset);
+
+        memset(&m_tx_queue[offset], 0, n);
+        p_resv->wr   += n;
+        p_resv->left -= n;
+    }
+
+    CRITICAL_REGION_ENTER();
+    m_tx_desc[p_resv->desc & TX_DESC_MASK].p_data = NULL;
+    tx_kick();
+    CRITICAL_REGION_EXIT();
+}
+
+
+static void printf_count(void const * p_user_ctx, char const * p_str, size_t length)
+{
+    UNUSED_PARAMETER(p_str);
+
+    *(size_t *)p_user_ctx += length;
+}
+
+
+static void printf_write(void const * p_user_ctx, char const * p_str, size_t length)
+{
+    uart_dma_tx_resv_write((uart_dma_tx_resv_t *)p_user_ctx, p_str, length);
+}
+
+
+ret_code_t uart_dma_vprintf(char const * p_fmt, va_list * p_args)
+{
+    ret_code_t         err_code;
+    uart_dma_tx_resv_t resv;
+    size_t             length = 0;
+    char               buf[UART_DMA_PRINTF_BUF_SIZE];
+    va_list            args;
+
+    // The contexts live on the stack, so the function may be called at any priority.
+    // The first pass only measures the message, so that it can be queued as one write.
+    nrf_fprintf_ctx_t count_ctx =
+    {
+        .p_io_buffer    = buf,
+        .io_buffer_size = sizeof(buf),
+        .io_buffer_cnt  = 0,
+        .auto_flush     = false,
+        .p_user_ctx     = &length,
+        .fwrite         = printf_count,
+    };
+
+    va_copy(args, *p_args);
+    nrf_fprintf_fmt(&count_ctx, p_fmt, &args);
+    nrf_fprintf_buffer_flush(&count_ctx);
+    va_end(args);
+
+    if (length == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    err_code = uart_dma_tx_reserve(length, &resv);
+    VERIFY_SUCCESS(err_code);
+
+    nrf_fprintf_ctx_t ctx =
+    {
+        .p_io_buffer    = buf,
+        .io_buffer_size = sizeof(buf),
+        .io_buffer_cnt  = 0,
+        .auto_flush     = false,
+        .p_user_ctx     = &resv,
+        .fwrite         = printf_write,
+    };
+
+    nrf_fprintf_fmt(&ctx, p_fmt, p_args);
+    nrf_fprintf_buffer_flush(&ctx);
+
+    uart_dma_tx_commit(&resv);
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t uart_dma_printf(char const * p_fmt, ...)
+{
+    ret_code_t err_code;
+    va_list    args;
+
+    va_start(args, p_fmt);
+    err_code = uart_dma_vprintf(p_fmt, &args);
+    va_end(args);
+
+    return err_code;
+}
+
+
+void uart_dma_rx_hold(uint8_t const * p_data)
+{
+    CRITICAL_REGION_ENTER();
+    m_rx_refcnt[rx_buf_idx(p_data)]++;
+    CRITICAL_REGION_EXIT();
+}
+
+
+void uart_dma_rx_release(uint8_t const * p_data)
+{
+    CRITICAL_REGION_ENTER();
+    rx_buf_unref(rx_buf_idx(p_data));
+    CRITICAL_REGION_EXIT();
+}
+
+
+ret_code_t uart_dma_tx_held(uint8_t const * p_data, size_t length)
+{
+    uart_dma_tx_seg_t const seg    = { .p_data = p_data, .length = length };
+    uint32_t                offset = (uint32_t)(p_data - &m_rx_pool[0][0]) % UART_DMA_RX_BUF_SIZE;
+
+    if (offset + length > UART_DMA_RX_BUF_SIZE)
+    {
+        uart_dma_rx_release(p_data);
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    return tx_enqueue(&seg, 1, TX_HELD, NULL);
+}
+
+
+bool uart_dma_tx_busy(void)
+{
+    return m_tx_busy;
+}
+
+
+size_t uart_dma_tx_pending(void)
+{
+    return m_tx_wr - m_tx_rd;
+}
+
+
+void uart_dma_tx_stats_get(uart_dma_tx_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_tx_stats;
+    CRITICAL_REGION_EXIT();
+}
+
+
+void uart_dma_rx_stats_get(uart_dma_rx_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_rx_stats;
+    CRITICAL_REGION_EXIT();
+}
@@ -0,0 +1,347 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup uart_dma UART EasyDMA transport
+ * @{
+ * @brief UARTE transport that hands whole buffers to EasyDMA.
+ *
+ * @details Data to send is copied into a bounded TX queue and the call returns
+ *          immediately. The queue is drained in chunks of up to
+ *          @ref UART_DMA_TX_BUF_SIZE bytes: one chunk is on the wire while new
+ *          messages are staged in the queue, and the CPU only runs when data is
+ *          queued and when EasyDMA reports that a chunk has been sent. What
+ *          happens when the queue is full is selected by
+ *          @ref uart_dma_tx_overflow_t.
+ *
+ *          Reception uses two alternating EasyDMA buffers. Received bytes are
+ *          counted in hardware by a TIMER in counter mode (RXDRDY -> COUNT via
+ *          PPI), and a second TIMER is restarted by every RXDRDY. When the line
+ *          has been quiet for @ref UART_DMA_RX_IDLE_BITS bit periods the second
+ *          TIMER's compare event fires, and everything received since the last
+ *          chunk is delivered in one @ref UART_DMA_EVT_RX_DATA event. A chunk
+ *          is also delivered when a buffer fills up. The CPU is therefore woken
+ *          once per frame rather than once per byte.
+ *
+ *          RX buffers are taken from a pool of @ref UART_DMA_RX_POOL_SIZE
+ *          buffers. The application may keep received data beyond the callback
+ *          by holding it with @ref uart_dma_rx_hold, and may send held data
+ *          without copying it with @ref uart_dma_tx_held; the buffer returns to
+ *          the pool when it has been sent. If every buffer is held, incoming
+ *          data is discarded and counted in @ref uart_dma_rx_stats_t.
+ */
+
+#ifndef UART_DMA_H__
+#define UART_DMA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#include "sdk_errors.h"
+#include "nrf_uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_DMA_TX_BUF_SIZE        255     /**< Size of the TX DMA buffer. Limited by the 8-bit EasyDMA MAXCNT register of nRF52832. */
+#define UART_DMA_TX_QUEUE_SIZE      1024    /**< Size of the TX queue. Must be a power of two. */
+#define UART_DMA_TX_DESC_COUNT      16      /**< Maximum number of queued writes sent by reference or reserved. Must be a power of two. */
+#define UART_DMA_RX_BUF_SIZE        128     /**< Size of each RX buffer. At most @ref UART_DMA_TX_BUF_SIZE. */
+#define UART_DMA_RX_POOL_SIZE       4       /**< Number of RX buffers. Two are owned by EasyDMA at any time. */
+#define UART_DMA_PRINTF_BUF_SIZE    32      /**< Size of the stack buffer nrf_fprintf formats into on the way to the TX queue. */
+#define UART_DMA_RX_IDLE_BITS       20      /**< Line idle time, in bit periods, that ends an RX chunk. */
+#define UART_DMA_RX_COUNTER_TIMER   1       /**< TIMER instance counting received bytes. */
+#define UART_DMA_RX_IDLE_TIMER      3       /**< TIMER instance measuring the RX idle gap. */
+
+/**@brief UART transport event types. */
+typedef enum
+{
+    UART_DMA_EVT_TX_DONE,   /**< A chunk of the TX queue has been sent. */
+    UART_DMA_EVT_RX_DATA,   /**< A chunk of data has been received. The data is only valid during the callback
+                                 unless it is held with @ref uart_dma_rx_hold. */
+    UART_DMA_EVT_ERROR,     /**< The UARTE reported a communication error. */
+} uart_dma_evt_type_t;
+
+/**@brief UART transport event. */
+typedef struct
+{
+    uart_dma_evt_type_t type;
+    union
+    {
+        struct
+        {
+            uint8_t const * p_data; /**< Transferred data. */
+            size_t          length; /**< Number of bytes transferred. */
+        } rxtx;                     /**< Valid for @ref UART_DMA_EVT_TX_DONE and @ref UART_DMA_EVT_RX_DATA. */
+        uint32_t error_mask;        /**< Content of the ERRORSRC register. Valid for @ref UART_DMA_EVT_ERROR. */
+    } data;
+} uart_dma_evt_t;
+
+/**@brief Policy applied when data is written to a full TX queue. */
+typedef enum
+{
+    UART_DMA_TX_OVERFLOW_DROP_NEWEST,   /**< Discard the data being written. */
+    UART_DMA_TX_OVERFLOW_DROP_OLDEST,   /**< Discard the oldest queued data to make room. */
+    UART_DMA_TX_OVERFLOW_BLOCK,         /**< Sleep until there is room or the timeout expires, then discard the
+                                             data being written. Falls back to dropping the newest data when
+                                             called from interrupt context. */
+} uart_dma_tx_overflow_t;
+
+/**@brief TX queue statistics. */
+typedef struct
+{
+    uint32_t dropped_bytes;     /**< Number of bytes discarded because the queue was full. */
+    uint32_t dropped_writes;    /**< Number of writes that lost data because the queue was full. */
+    uint32_t high_water_mark;   /**< Highest number of bytes held in the queue. */
+} uart_dma_tx_stats_t;
+
+/**@brief RX statistics. */
+typedef struct
+{
+    uint32_t dropped_bytes;     /**< Number of bytes discarded because every RX buffer was held. */
+} uart_dma_rx_stats_t;
+
+/**@brief Piece of data for @ref uart_dma_tx_gather. */
+typedef struct
+{
+    void const * p_data;    /**< Data to send. */
+    size_t       length;    /**< Number of bytes. */
+} uart_dma_tx_seg_t;
+
+/**@brief Space reserved in the TX queue, see @ref uart_dma_tx_reserve. */
+typedef struct
+{
+    uint32_t wr;            /**< Queue position of the next byte to write. */
+    uint32_t left;          /**< Number of reserved bytes not written yet. */
+    uint32_t desc;          /**< Queue entry of the reservation. */
+} uart_dma_tx_resv_t;
+
+/**@brief UART transport event handler. Called from the UARTE interrupt. */
+typedef void (* uart_dma_evt_handler_t)(uart_dma_evt_t const * p_evt);
+
+/**@brief UART transport configuration. */
+typedef struct
+{
+    uint32_t               rx_pin;              /**< RXD pin number. */
+    uint32_t               tx_pin;              /**< TXD pin number. */
+    uint32_t               rts_pin;             /**< RTS pin number. */
+    uint32_t               cts_pin;             /**< CTS pin number. */
+    nrf_uart_hwfc_t        hwfc;                /**< Flow control configuration. */
+    nrf_uart_baudrate_t    baudrate;            /**< Baud rate. */
+    uint8_t                irq_priority;        /**< UARTE interrupt priority. */
+    uart_dma_tx_overflow_t tx_overflow;         /**< TX queue overflow policy. */
+    uint32_t               tx_block_timeout_ms; /**< Timeout for @ref UART_DMA_TX_OVERFLOW_BLOCK. */
+} uart_dma_config_t;
+
+/**@brief Function for initializing the UART transport and starting reception.
+ *
+ * @param[in] p_config      Transport configuration.
+ * @param[in] evt_handler   Event handler. Must not be NULL.
+ *
+ * @retval NRF_SUCCESS              The transport has been initialized.
+ * @retval NRF_ERROR_INVALID_STATE  The UARTE or TIMER drivers are already in use.
+ * @retval NRF_ERROR_NO_MEM         No free PPI channels.
+ */
+ret_code_t uart_dma_init(uart_dma_config_t const * p_config, uart_dma_evt_handler_t evt_handler);
+
+/**@brief Function for changing the baud rate and flow control at runtime.
+ *
+ * @details Stops reception and delivers the data received so far, then
+ *          waits until the TX queue has been sent at the current rate and
+ *          restarts the UARTE with the new settings. Data arriving during the
+ *          switch is dropped. Must be called from thread mode.
+ *
+ * @param[in] baudrate  New baud rate.
+ * @param[in] hwfc      New flow control configuration. The RTS and CTS pins
+ *                      given to @ref uart_dma_init are used.
+ *
+ * @retval NRF_SUCCESS              The UARTE runs with the new settings.
+ * @retval NRF_ERROR_INVALID_STATE  Called from interrupt context.
+ */
+ret_code_t uart_dma_reconfigure(nrf_uart_baudrate_t baudrate, nrf_uart_hwfc_t hwfc);
+
+/**@brief Function for queuing data for transmission.
+ *
+ * @details The data is copied into the TX queue, so the caller may reuse @p p_data
+ *          as soon as the function returns. If nothing is on the wire the transfer
+ *          is started immediately. A write is either queued completely or, under
+ *          @ref UART_DMA_TX_OVERFLOW_DROP_NEWEST and @ref UART_DMA_TX_OVERFLOW_BLOCK,
+ *          not at all. The function may be called from interrupt context.
+ *
+ * @param[in] p_data    Data to send.
+ * @param[in] length    Number of bytes. At most @ref UART_DMA_TX_QUEUE_SIZE.
+ *
+ * @retval NRF_SUCCESS              The data has been queued.
+ * @retval NRF_ERROR_INVALID_LENGTH @p length is zero or larger than the queue.
+ * @retval NRF_ERROR_INVALID_STATE  The transport has not been initialized.
+ * @retval NRF_ERROR_NO_MEM         The queue was full and the data was discarded.
+ */
+ret_code_t uart_dma_tx(uint8_t const * p_data, size_t length);
+
+/**@brief Function for queuing several pieces of data as one write.
+ *
+ * @details Like @ref uart_dma_tx, but the segments are copied straight into the TX
+ *          queue one after the other and queued or discarded together, so a
+ *          header and a body need no staging buffer and are never separated.
+ *
+ * @param[in] p_segs    Segments.
+ * @param[in] count     Number of segments.
+ *
+ * @return See @ref uart_dma_tx. The length limit applies to the sum of the segments.
+ */
+ret_code_t uart_dma_tx_gather(uart_dma_tx_seg_t const * p_segs, size_t count);
+
+/**@brief Function for reserving space in the TX queue.
+ *
+ * @details The space is queued in order with other writes, but neither sent
+ *          nor dropped until it is committed with @ref uart_dma_tx_commit.
+ *          Fill it with @ref uart_dma_tx_resv_write in between. This lets a
+ *          message be built straight in the queue and still be queued or
+ *          discarded as one write. Later writes wait behind the reservation,
+ *          so commit it soon. The function may be called from interrupt
+ *          context; the overflow policy applies as for @ref uart_dma_tx.
+ *
+ * @param[in]  length   Number of bytes. At most @ref UART_DMA_TX_QUEUE_SIZE.
+ * @param[out] p_resv   Reservation.
+ *
+ * @return See @ref uart_dma_tx.
+ */
+ret_code_t uart_dma_tx_reserve(size_t length, uart_dma_tx_resv_t * p_resv);
+
+/**@brief Function for writing the next bytes of a reservation. Bytes beyond the reserved length are ignored.
+ *
+ * @param[in,out] p_resv    Reservation.
+ * @param[in]     p_data    Data.
+ * @param[in]     length    Number of bytes.
+ */
+void uart_dma_tx_resv_write(uart_dma_tx_resv_t * p_resv, void const * p_data, size_t length);
+
+/**@brief Function for committing a reservation. Reserved bytes that were not written are sent as zeros.
+ *
+ * @param[in,out] p_resv    Reservation.
+ */
+void uart_dma_tx_commit(uart_dma_tx_resv_t * p_resv);
+
+/**@brief Function for formatting a string into the TX queue.
+ *
+ * @details The message is formatted twice by nrf_fprintf: once to measure it,
+ *          and once into space reserved for it with @ref uart_dma_tx_reserve,
+ *          through a stack buffer of @ref UART_DMA_PRINTF_BUF_SIZE bytes. The
+ *          message is therefore queued or discarded as a whole, and data
+ *          written by an interrupt never lands inside it. The arguments must
+ *          not change during the call. The function may be called from
+ *          interrupt context.
+ *
+ * @param[in] p_fmt     printf style format string.
+ *
+ * @retval NRF_SUCCESS  The message has been queued.
+ * @return Errors from @ref uart_dma_tx_reserve.
+ */
+ret_code_t uart_dma_printf(char const * p_fmt, ...);
+
+/**@brief Function for formatting a string into the TX queue, see @ref uart_dma_printf.
+ *
+ * @param[in] p_fmt     printf style format string.
+ * @param[in] p_args    Arguments.
+ */
+ret_code_t uart_dma_vprintf(char const * p_fmt, va_list * p_args);
+
+/**@brief Function for keeping received data beyond the @ref UART_DMA_EVT_RX_DATA callback.
+ *
+ * @details Takes a reference on the RX buffer that contains @p p_data. The buffer is
+ *          not reused until every reference has been released with
+ *          @ref uart_dma_rx_release or handed over with @ref uart_dma_tx_held.
+ *
+ * @param[in] p_data    Pointer into data delivered by @ref UART_DMA_EVT_RX_DATA.
+ */
+void uart_dma_rx_hold(uint8_t const * p_data);
+
+/**@brief Function for releasing received data held with @ref uart_dma_rx_hold.
+ *
+ * @param[in] p_data    Pointer passed to @ref uart_dma_rx_hold.
+ */
+void uart_dma_rx_release(uint8_t const * p_data);
+
+/**@brief Function for sending held received data without copying it.
+ *
+ * @details The reference taken with @ref uart_dma_rx_hold is handed over to the
+ *          transport, which sends the data straight from the RX buffer and releases
+ *          it when it has been sent. Ownership is transferred even if the function
+ *          fails, in which case the data is released immediately. The overflow
+ *          policy applies as for @ref uart_dma_tx. The function may be called from
+ *          interrupt context.
+ *
+ * @param[in] p_data    Held data. Must lie within a single RX buffer.
+ * @param[in] length    Number of bytes.
+ *
+ * @retval NRF_SUCCESS              The data has been queued.
+ * @retval NRF_ERROR_INVALID_LENGTH @p length is zero or crosses the end of the RX buffer.
+ * @retval NRF_ERROR_NO_MEM         The queue was full and the data was discarded.
+ */
+ret_code_t uart_dma_tx_held(uint8_t const * p_data, size_t length);
+
+/**@brief Function for checking if a transmission is in progress. */
+bool uart_dma_tx_busy(void);
+
+/**@brief Function for getting the number of copied bytes waiting in the TX queue. */
+size_t uart_dma_tx_pending(void);
+
+/**@brief Function for reading the TX queue statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void uart_dma_tx_stats_get(uart_dma_tx_stats_t * p_stats);
+
+/**@brief Function for reading the RX statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void uart_dma_rx_stats_get(uart_dma_rx_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_DMA_H__
+
+/** @} */
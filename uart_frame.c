@@ -0,0 +1,418 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "uart_frame.h"
+#include "uart_dma.h"
+#include "crc16.h"
+#include "nrf_fprintf.h"
+#include "nrf_fprintf_format.h"
+#include "app_util_platform.h"
+#include "sdk_macros.h"
+
+#define SLIP_END        0xC0    // End of frame.
+#define SLIP_ESC        0xDB    // Escapes the next byte.
+#define SLIP_ESC_END    0xDC    // Escaped END.
+#define SLIP_ESC_ESC    0xDD    // Escaped ESC.
+
+#define FRAME_HDR_LEN   1       // Type byte.
+#define FRAME_CRC_LEN   2
+#define FRAME_MAX_LEN   (FRAME_HDR_LEN + UART_FRAME_MAX_PAYLOAD + FRAME_CRC_LEN)
+
+// Worst case: every byte escaped, plus the leading and trailing END.
+#define FRAME_MAX_ENCODED_LEN   (2 * FRAME_MAX_LEN + 2)
+
+STATIC_ASSERT(FRAME_MAX_ENCODED_LEN <= UART_DMA_TX_QUEUE_SIZE);
+
+// State of uart_frame_vprintf(). The payload is formatted twice: to measure and checksum it,
+// and to encode it into the space reserved for the frame in the TX queue.
+typedef struct
+{
+    bool               measure;     // First pass.
+    size_t             length;      // Payload length.
+    size_t             encoded;     // Encoded payload length.
+    uint16_t           crc;
+    uart_dma_tx_resv_t resv;
+} printf_frame_t;
+
+static uart_frame_handler_t m_handler;
+static uart_frame_stats_t   m_stats;
+
+// Decoder state.
+static uint8_t              m_rx_frame[FRAME_MAX_LEN];
+static size_t               m_rx_len;
+static bool                 m_rx_esc;       // The previous byte was ESC.
+static bool                 m_rx_discard;   // The frame is broken, skip everything up to the next END.
+static bool                 m_rx_handling;  // The frame handler is running.
+
+// Encoded bytes of the frame in the chunk being decoded, for uart_frame_forward().
+static uint8_t const *      mp_rx_raw;      // Start of the frame, NULL if it began in an earlier chunk.
+static size_t               m_rx_raw_len;   // Length up to and including the closing END.
+
+
+static void rx_append(uint8_t const * p_data, size_t length)
+{
+    if (m_rx_discard)
+    {
+        return;
+    }
+
+    if (length > sizeof(m_rx_frame) - m_rx_len)
+    {
+        m_rx_discard = true;
+        return;
+    }
+
+    memcpy(&m_rx_frame[m_rx_len], p_data, length);
+    m_rx_len += length;
+}
+
+
+/**@brief Function for handling an END byte. */
+static void rx_frame_end(void)
+{
+    if (m_rx_discard || m_rx_esc)
+    {
+        m_stats.rx_framing_errors++;
+    }
+    else if (m_rx_len == 0)
+    {
+        // Back-to-back END bytes, nothing to do.
+    }
+    else if (m_rx_len < FRAME_HDR_LEN + FRAME_CRC_LEN)
+    {
+        m_stats.rx_crc_errors++;
+    }
+    else
+    {
+        size_t   data_len = m_rx_len - FRAME_CRC_LEN;
+        uint16_t crc      = crc16_compute(m_rx_frame, data_len, NULL);
+
+        if (uint16_decode(&m_rx_frame[data_len]) == crc)
+        {
+            m_stats.rx_frames++;
+            m_rx_handling = true;
+            m_handler(m_rx_frame[0], &m_rx_frame[FRAME_HDR_LEN], data_len - FRAME_HDR_LEN);
+            m_rx_handling = false;
+        }
+        else
+        {
+            m_stats.rx_crc_errors++;
+        }
+    }
+
+    m_rx_len     = 0;
+    m_rx_esc     = false;
+    m_rx_discard = false;
+}
+
+
+ret_code_t uart_frame_init(uart_frame_handler_t handler)
+{
+    VERIFY_PARAM_NOT_NULL(handler);
+
+    m_handler    = handler;
+    m_rx_len     = 0;
+    m_rx_esc     = false;
+    m_rx_discard = false;
+    mp_rx_raw    = NULL;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    return NRF_SUCCESS;
+}
+
+
+void uart_frame_input(uint8_t const * p_data, size_t length)
+{
+    size_t i = 0;
+
+    // A frame that starts with the chunk can be forwarded from it.
+    mp_rx_raw = ((m_rx_len == 0) && !m_rx_esc && !m_rx_discard) ? p_data : NULL;
+
+    while (i < length)
+    {
+        if (m_rx_esc)
+        {
+            m_rx_esc = false;
+
+            switch (p_data[i])
+            {
+                case SLIP_ESC_END:
+                    rx_append((uint8_t const []){ SLIP_END }, 1);
+                    i++;
+                    break;
+
+                case SLIP_ESC_ESC:
+                    rx_append((uint8_t const []){ SLIP_ESC }, 1);
+                    i++;
+                    break;
+
+                case SLIP_END:
+                    // Handled below, which also counts the error.
+                    m_rx_discard = true;
+                    break;
+
+                default:
+                    m_rx_discard = true;
+                    i++;
+                    break;
+            }
+            continue;
+        }
+
+        // Copy the run of plain bytes up to the next END or ESC.
+        size_t run = i;
+        while ((run < length) && (p_data[run] != SLIP_END) && (p_data[run] != SLIP_ESC))
+        {
+            run++;
+        }
+        rx_append(&p_data[i], run - i);
+        i = run;
+
+        if (i < length)
+        {
+            if (p_data[i] == SLIP_END)
+            {
+                m_rx_raw_len = (mp_rx_raw != NULL) ? (size_t)(&p_data[i + 1] - mp_rx_raw) : 0;
+                rx_frame_end();
+
+                // The END also opens the next frame.
+                mp_rx_raw = &p_data[i];
+            }
+            else
+            {
+                m_rx_esc = true;
+            }
+            i++;
+        }
+    }
+}
+
+
+static size_t slip_encode_block(uint8_t * p_out, uint8_t const * p_in, size_t length)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        switch (p_in[i])
+        {
+            case SLIP_END:
+                p_out[n++] = SLIP_ESC;
+                p_out[n++] = SLIP_ESC_END;
+                break;
+
+            case SLIP_ESC:
+                p_out[n++] = SLIP_ESC;
+                p_out[n++] = SLIP_ESC_ESC;
+                break;
+
+            default:
+                p_out[n++] = p_in[i];
+                break;
+        }
+    }
+
+    return n;
+}
+
+
+ret_code_t uart_frame_send(uint8_t type, void const * p_payload, size_t length)
+{
+    ret_code_t err_code;
+    uint8_t    encoded[FRAME_MAX_ENCODED_LEN];
+    uint8_t    crc_le[FRAME_CRC_LEN];
+    uint16_t   crc;
+    size_t     n = 0;
+
+    if (length > UART_FRAME_MAX_PAYLOAD)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    crc = crc16_compute(&type, 1, NULL);
+    crc = crc16_compute(p_payload, length, &crc);
+    (void)uint16_encode(crc, crc_le);
+
+    // The leading END flushes any line noise the receiver has collected.
+    encoded[n++] = SLIP_END;
+    n += slip_encode_block(&encoded[n], &type, 1);
+    n += slip_encode_block(&encoded[n], p_payload, length);
+    n += slip_encode_block(&encoded[n], crc_le, sizeof(crc_le));
+    encoded[n++] = SLIP_END;
+
+    err_code = uart_dma_tx(encoded, n);
+    VERIFY_SUCCESS(err_code);
+
+    CRITICAL_REGION_ENTER();
+    m_stats.tx_frames++;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+static void printf_encode(void const * p_user_ctx, char const * p_str, size_t length)
+{
+    printf_frame_t * p_frame = (printf_frame_t *)p_user_ctx;
+    uint8_t          encoded[2 * UART_DMA_PRINTF_BUF_SIZE];
+    size_t           n       = slip_encode_block(encoded, (uint8_t const *)p_str, length);
+
+    if (p_frame->measure)
+    {
+        p_frame->length  += length;
+        p_frame->encoded += n;
+        p_frame->crc      = crc16_compute((uint8_t const *)p_str, length, &p_frame->crc);
+    }
+    else
+    {
+        uart_dma_tx_resv_write(&p_frame->resv, encoded, n);
+    }
+}
+
+
+ret_code_t uart_frame_vprintf(uint8_t type, char const * p_fmt, va_list * p_args)
+{
+    ret_code_t     err_code;
+    printf_frame_t frame = { .measure = true, .length = 0, .encoded = 0 };
+    uint8_t        head[1 + 2 * FRAME_HDR_LEN];
+    uint8_t        tail[2 * FRAME_CRC_LEN + 1];
+    uint8_t        crc_le[FRAME_CRC_LEN];
+    size_t         head_len = 0;
+    size_t         tail_len;
+    char           buf[UART_DMA_PRINTF_BUF_SIZE];
+    va_list        args;
+
+    nrf_fprintf_ctx_t ctx =
+    {
+        .p_io_buffer    = buf,
+        .io_buffer_size = sizeof(buf),
+        .io_buffer_cnt  = 0,
+        .auto_flush     = false,
+        .p_user_ctx     = &frame,
+        .fwrite         = printf_encode,
+    };
+
+    frame.crc = crc16_compute(&type, 1, NULL);
+
+    va_copy(args, *p_args);
+    nrf_fprintf_fmt(&ctx, p_fmt, &args);
+    nrf_fprintf_buffer_flush(&ctx);
+    va_end(args);
+
+    if (frame.length > UART_FRAME_MAX_PAYLOAD)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    (void)uint16_encode(frame.crc, crc_le);
+    head[head_len++] = SLIP_END;
+    head_len += slip_encode_block(&head[head_len], &type, 1);
+    tail_len  = slip_encode_block(tail, crc_le, sizeof(crc_le));
+    tail[tail_len++] = SLIP_END;
+
+    // The whole frame is queued or dropped as one write.
+    err_code = uart_dma_tx_reserve(head_len + frame.encoded + tail_len, &frame.resv);
+    VERIFY_SUCCESS(err_code);
+
+    uart_dma_tx_resv_write(&frame.resv, head, head_len);
+    frame.measure = false;
+    nrf_fprintf_fmt(&ctx, p_fmt, p_args);
+    nrf_fprintf_buffer_flush(&ctx);
+    uart_dma_tx_resv_write(&frame.resv, tail, tail_len);
+    uart_dma_tx_commit(&frame.resv);
+
+    CRITICAL_REGION_ENTER();
+    m_stats.tx_frames++;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t uart_frame_printf(uint8_t type, char const * p_fmt, ...)
+{
+    ret_code_t err_code;
+    va_list    args;
+
+    va_start(args, p_fmt);
+    err_code = uart_frame_vprintf(type, p_fmt, &args);
+    va_end(args);
+
+    return err_code;
+}
+
+
+ret_code_t uart_frame_forward(void)
+{
+    ret_code_t err_code;
+
+    if (!m_rx_handling)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (mp_rx_raw == NULL)
+    {
+        // The frame spans chunks, encode it again from the frame buffer.
+        return uart_frame_send(m_rx_frame[0], &m_rx_frame[FRAME_HDR_LEN],
+                               m_rx_len - FRAME_HDR_LEN - FRAME_CRC_LEN);
+    }
+
+    // The received bytes are a valid encoded frame, send them straight from the RX buffer.
+    uart_dma_rx_hold(mp_rx_raw);
+    err_code = uart_dma_tx_held(mp_rx_raw, m_rx_raw_len);
+    VERIFY_SUCCESS(err_code);
+
+    CRITICAL_REGION_ENTER();
+    m_stats.tx_frames++;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+void uart_frame_stats_get(uart_frame_stats_t * p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = m_stats;
+    CRITICAL_REGION_EXIT();
+}
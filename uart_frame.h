@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/** @file
+ *
+ * @defgroup uart_frame SLIP framed UART channel
+ * @{
+ * @brief Binary frames with a CRC16 over the UART EasyDMA transport.
+ *
+ * @details A frame carries a type byte, up to @ref UART_FRAME_MAX_PAYLOAD bytes
+ *          of payload and a CRC16-CCITT of both, stored little-endian. The frame
+ *          is SLIP encoded (RFC 1055) and surrounded by END bytes, so a receiver
+ *          that has lost sync resynchronizes at the next END.
+ *
+ *          The decoder is fed the chunks delivered by @ref UART_DMA_EVT_RX_DATA.
+ *          Runs of plain bytes are copied into the frame buffer in one go, and
+ *          only END and ESC bytes are handled individually. Frames that are too
+ *          long, badly escaped or fail the CRC check are dropped and counted in
+ *          @ref uart_frame_stats_t.
+ *
+ *          A received frame can be sent on unchanged with @ref uart_frame_forward.
+ *          When the frame lies within one RX chunk, its encoded bytes are sent
+ *          by reference from the RX buffer, see @ref uart_dma_tx_held.
+ */
+
+#ifndef UART_FRAME_H__
+#define UART_FRAME_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_FRAME_MAX_PAYLOAD  128     /**< Maximum payload length of a frame. */
+
+/**@brief Frame handler. Called from the context that feeds the decoder.
+ *
+ * @param[in] type      Frame type.
+ * @param[in] p_payload Payload. Only valid during the call.
+ * @param[in] length    Payload length.
+ */
+typedef void (* uart_frame_handler_t)(uint8_t type, uint8_t const * p_payload, size_t length);
+
+/**@brief Framing statistics. */
+typedef struct
+{
+    uint32_t rx_frames;         /**< Number of valid frames received. */
+    uint32_t rx_crc_errors;     /**< Number of frames dropped because of a CRC mismatch or a missing CRC. */
+    uint32_t rx_framing_errors; /**< Number of frames dropped because they were too long or badly escaped. */
+    uint32_t tx_frames;         /**< Number of frames queued for transmission. */
+} uart_frame_stats_t;
+
+/**@brief Function for initializing the framing layer.
+ *
+ * @details The UART itself is initialized with @ref uart_dma_init.
+ *
+ * @param[in] handler   Handler for received frames. Must not be NULL.
+ *
+ * @retval NRF_SUCCESS          The framing layer has been initialized.
+ * @retval NRF_ERROR_NULL       @p handler is NULL.
+ */
+ret_code_t uart_frame_init(uart_frame_handler_t handler);
+
+/**@brief Function for decoding a chunk of received data.
+ *
+ * @details Frames may span any number of chunks. The frame handler is called
+ *          for each complete frame.
+ *
+ * @param[in] p_data    Received data.
+ * @param[in] length    Number of bytes.
+ */
+void uart_frame_input(uint8_t const * p_data, size_t length);
+
+/**@brief Function for encoding and queuing a frame.
+ *
+ * @param[in] type      Frame type.
+ * @param[in] p_payload Payload. May be NULL if @p length is zero.
+ * @param[in] length    Payload length. At most @ref UART_FRAME_MAX_PAYLOAD.
+ *
+ * @retval NRF_SUCCESS              The frame has been queued.
+ * @retval NRF_ERROR_INVALID_LENGTH The payload is too long.
+ * @return Other errors from @ref uart_dma_tx.
+ */
+ret_code_t uart_frame_send(uint8_t type, void const * p_payload, size_t length);
+
+/**@brief Function for formatting a text payload straight into a frame.
+ *
+ * @details The payload is formatted by nrf_fprintf twice, to measure and then
+ *          to encode it into space reserved with @ref uart_dma_tx_reserve. No
+ *          payload buffer is needed, and the frame is queued as one write. The
+ *          arguments must not change during the call.
+ *
+ * @param[in] type      Frame type.
+ * @param[in] p_fmt     printf style format string.
+ *
+ * @retval NRF_SUCCESS              The frame has been queued.
+ * @retval NRF_ERROR_INVALID_LENGTH The payload is longer than @ref UART_FRAME_MAX_PAYLOAD.
+ * @return Other errors from @ref uart_dma_tx_reserve.
+ */
+ret_code_t uart_frame_printf(uint8_t type, char const * p_fmt, ...);
+
+/**@brief Function for formatting a text payload straight into a frame, see @ref uart_frame_printf.
+ *
+ * @param[in] type      Frame type.
+ * @param[in] p_fmt     printf style format string.
+ * @param[in] p_args    Arguments.
+ */
+ret_code_t uart_frame_vprintf(uint8_t type, char const * p_fmt, va_list * p_args);
+
+/**@brief Function for sending the frame being handled on unchanged.
+ *
+ * @details Only valid in the frame handler. The received encoded bytes are
+ *          queued without a copy and the RX buffer is held until they have been
+ *          sent. A frame that spans several chunks is encoded again instead.
+ *
+ * @retval NRF_SUCCESS              The frame has been queued.
+ * @retval NRF_ERROR_INVALID_STATE  Not called from the frame handler.
+ * @return Other errors from @ref uart_dma_tx_held or @ref uart_frame_send.
+ */
+ret_code_t uart_frame_forward(void);
+
+/**@brief Function for reading the framing statistics.
+ *
+ * @param[out] p_stats  Statistics.
+ */
+void uart_frame_stats_get(uart_frame_stats_t * p_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_FRAME_H__
+
+/** @} */